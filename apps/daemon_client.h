@@ -0,0 +1,114 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+/*
+ * elfjackd speaks a line protocol over a Unix socket.  Each request is one line and gets exactly one line in
+ * response, in order, so requests can be pipelined:
+ *
+ *     F <length>:<function name> <path>      ->  0x<relative address>
+ *     G <length>:<function name> <path>      ->  0x<relative address of the GOT entry>
+ *     S <length>:<addr>[,<addr>...] <path>   ->  <name>+0x<offset> or ? for each address, separated by spaces
+ *
+ * The argument is prefixed with its length in bytes so that it may contain spaces (as demangled names do).
+ * The path is the remainder of the line.  The daemon resolves relative paths against its own working
+ * directory, so clients should send absolute ones.  Failures are reported as "! <message>".  If a response
+ * can't be formatted at all, the connection is closed rather than left without it.
+ */
+
+#define EJD_MAX_LINE 4096
+
+static inline int
+ejdConnect(const char *socket_path)
+{
+    int fd;
+    struct sockaddr_un addr = {.sun_family = AF_UNIX};
+
+    if (strlen(socket_path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "Socket path is too long\n");
+        return -1;
+    }
+    strcpy(addr.sun_path, socket_path);
+
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        perror("socket");
+        return -1;
+    }
+    if (connect(fd, (const struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        perror("connect");
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+/*
+ * Sends a single F or G request and prints the address.  Returns 0 if the address was found, 1 if the
+ * daemon reported a failure, and -1 if it couldn't be reached.
+ */
+static inline int
+ejdLookup(const char *socket_path, char command, const char *path, const char *func_name)
+{
+    int fd, len;
+    size_t received = 0;
+    char line[EJD_MAX_LINE], *full_path;
+
+    full_path = realpath(path, NULL);
+    if (!full_path) {
+        perror(path);
+        return -1;
+    }
+    len = snprintf(line, sizeof(line), "%c %zu:%s %s\n", command, strlen(func_name), func_name, full_path);
+    free(full_path);
+    if (len < 0 || (size_t)len >= sizeof(line)) {
+        fprintf(stderr, "Request is too long\n");
+        return -1;
+    }
+
+    fd = ejdConnect(socket_path);
+    if (fd < 0) {
+        return -1;
+    }
+    if (send(fd, line, len, MSG_NOSIGNAL) != len) {
+        perror("send");
+        close(fd);
+        return -1;
+    }
+
+    while (received < sizeof(line) - 1) {
+        ssize_t count;
+
+        count = recv(fd, line + received, sizeof(line) - 1 - received, 0);
+        if (count <= 0) {
+            break;
+        }
+        received += count;
+        if (memchr(line + received - count, '\n', count)) {
+            break;
+        }
+    }
+    close(fd);
+
+    line[received] = '\0';
+    line[strcspn(line, "\n")] = '\0';
+    if (line[0] == '\0') {
+        fprintf(stderr, "No response from the daemon\n");
+        return -1;
+    }
+    if (line[0] == '!') {
+        if (strcmp(line, "! not found") != 0) {
+            fprintf(stderr, "%s\n", line + 2);
+        }
+        return 1;
+    }
+
+    printf("%s\n", line);
+    return 0;
+}
@@ -0,0 +1,91 @@
+#include <stdio.h>
+#include <string.h>
+
+#include <elfjack/elfjack.h>
+
+static void
+usage(const char *executable)
+{
+    fprintf(stderr, "Usage: %s [path to old elf] [path to new elf]", executable);
+}
+
+static void
+printAddr(const char *prefix, ejAddr addr)
+{
+    if (addr == EJ_ADDR_NOT_FOUND) {
+        printf("%s-", prefix);
+    }
+    else {
+        printf("%s0x%llx", prefix, addr);
+    }
+}
+
+int
+main(int argc, char **argv)
+{
+    int ret;
+    const char *executable = argv[0];
+    ejElfInfo old_info, new_info;
+    ejSymbolDiff diff;
+
+    if (argc == 2 && (strcmp(argv[1], "-h") == 0 || strcmp(argv[1], "--help") == 0)) {
+        usage(executable);
+        return 0;
+    }
+
+    if (argc != 3) {
+        usage(executable);
+        return EJ_RET_BAD_USAGE;
+    }
+
+    ret = ejParseElf(argv[1], &old_info);
+    if (ret != EJ_RET_OK) {
+        fprintf(stderr, "Failed to parse ELF file: %s\n", ejGetError());
+        return ret;
+    }
+
+    ret = ejParseElf(argv[2], &new_info);
+    if (ret != EJ_RET_OK) {
+        fprintf(stderr, "Failed to parse ELF file: %s\n", ejGetError());
+        ejReleaseInfo(&old_info);
+        return ret;
+    }
+
+    ret = ejDiffSymbols(&old_info, &new_info, &diff);
+    if (ret != EJ_RET_OK) {
+        fprintf(stderr, "Failed to diff the symbols: %s\n", ejGetError());
+        goto done;
+    }
+
+    // Each line is "<+|-|~> name value size got", where a changed function lists the old and new values.
+    for (size_t k = 0; k < diff.num_changes; k++) {
+        const ejSymbolChange *change = &diff.changes[k];
+
+        switch (change->kind) {
+        case EJ_SYMBOL_ADDED:
+            printf("+ %s 0x%llx %llu", change->name, change->new_value, (unsigned long long)change->new_size);
+            printAddr(" ", change->new_got);
+            break;
+        case EJ_SYMBOL_REMOVED:
+            printf("- %s 0x%llx %llu", change->name, change->old_value, (unsigned long long)change->old_size);
+            printAddr(" ", change->old_got);
+            break;
+        case EJ_SYMBOL_CHANGED:
+            printf("~ %s 0x%llx->0x%llx %llu->%llu", change->name, change->old_value, change->new_value,
+                   (unsigned long long)change->old_size, (unsigned long long)change->new_size);
+            printAddr(" ", change->old_got);
+            printAddr("->", change->new_got);
+            break;
+        }
+        printf("\n");
+    }
+
+    // Like diff(1), exit with 1 if there are any differences.
+    ret = (diff.num_changes > 0) ? 1 : 0;
+    ejReleaseSymbolDiff(&diff);
+
+done:
+    ejReleaseInfo(&old_info);
+    ejReleaseInfo(&new_info);
+    return ret;
+}
@@ -0,0 +1,523 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/inotify.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <elfjack/elfjack.h>
+
+#include "daemon_client.h"
+
+#define MAX_CLIENTS  64
+#define NUM_BUCKETS  256
+#define WATCH_EVENTS (IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB | IN_DELETE_SELF | IN_MOVE_SELF)
+
+struct cachedFile {
+    struct cachedFile *next;
+    dev_t dev;
+    ino_t ino;
+    int wd;
+    ejElfInfo info;
+};
+
+struct output {
+    char *data;
+    size_t used;
+    size_t size;
+    // Set when a response couldn't be formatted, in which case the connection is closed.
+    bool failed;
+};
+
+struct client {
+    int fd;
+    size_t used;
+    char buffer[EJD_MAX_LINE];
+    // Responses which haven't been sent yet.  No more requests are read until they have been.
+    struct output out;
+    size_t sent;
+};
+
+static struct cachedFile *buckets[NUM_BUCKETS];
+static struct client clients[MAX_CLIENTS];
+static int inotify_fd = -1;
+static volatile sig_atomic_t stopping;
+
+static void
+usage(const char *executable)
+{
+    fprintf(stderr, "Usage: %s [socket path]\n", executable);
+}
+
+static void
+handleSignal(int signum)
+{
+    (void)signum;
+    stopping = 1;
+}
+
+static struct cachedFile **
+bucketFor(dev_t dev, ino_t ino)
+{
+    return &buckets[(dev * 31 + ino) % NUM_BUCKETS];
+}
+
+static void
+evict(int wd)
+{
+    for (unsigned int k = 0; k < NUM_BUCKETS; k++) {
+        for (struct cachedFile **link = &buckets[k]; *link; link = &(*link)->next) {
+            struct cachedFile *file = *link;
+
+            if (file->wd == wd) {
+                *link = file->next;
+                inotify_rm_watch(inotify_fd, wd);
+                ejReleaseInfo(&file->info);
+                free(file);
+                return;
+            }
+        }
+    }
+}
+
+/*
+ * Files are cached by identity (device and inode) so that every path leading to a file shares one parse and
+ * replacing a file (e.g., by renaming a new build over it) is noticed without any notification.  inotify
+ * catches files modified in place.
+ */
+static const ejElfInfo *
+lookupFile(const char *path, const char **error)
+{
+    int ret;
+    struct stat fs;
+    struct cachedFile *file, **bucket;
+
+    if (stat(path, &fs) != 0) {
+        *error = strerror(errno);
+        return NULL;
+    }
+
+    bucket = bucketFor(fs.st_dev, fs.st_ino);
+    for (file = *bucket; file; file = file->next) {
+        if (file->dev == fs.st_dev && file->ino == fs.st_ino) {
+            return &file->info;
+        }
+    }
+
+    file = malloc(sizeof(*file));
+    if (!file) {
+        *error = strerror(ENOMEM);
+        return NULL;
+    }
+
+    // Watch before parsing so that a modification racing with the parse isn't missed.
+    file->wd = inotify_add_watch(inotify_fd, path, WATCH_EVENTS);
+    if (file->wd < 0) {
+        *error = strerror(errno);
+        free(file);
+        return NULL;
+    }
+
+    ret = ejParseElfWithFlags(path, &file->info, EJ_PARSE_DEBUGINFO);
+    if (ret != EJ_RET_OK) {
+        *error = ejGetError();
+        inotify_rm_watch(inotify_fd, file->wd);
+        free(file);
+        return NULL;
+    }
+
+    file->dev = fs.st_dev;
+    file->ino = fs.st_ino;
+    file->next = *bucket;
+    *bucket = file;
+    return &file->info;
+}
+
+static void
+drainInotify(void)
+{
+    char events[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    ssize_t count;
+
+    while ((count = read(inotify_fd, events, sizeof(events))) > 0) {
+        for (char *ptr = events; ptr < events + count;) {
+            const struct inotify_event *event = (const void *)ptr;
+
+            if (!(event->mask & IN_IGNORED)) {
+                evict(event->wd);
+            }
+            ptr += sizeof(*event) + event->len;
+        }
+    }
+}
+
+static void
+appendf(struct output *out, const char *format, ...) __attribute__((format(printf, 2, 3)));
+
+static void
+appendf(struct output *out, const char *format, ...)
+{
+    int len;
+    char *data;
+    va_list args;
+
+    for (;;) {
+        va_start(args, format);
+        len = vsnprintf(out->data + out->used, out->size - out->used, format, args);
+        va_end(args);
+        if (len < 0) {
+            out->failed = true;
+            return;
+        }
+        if ((size_t)len < out->size - out->used) {
+            out->used += len;
+            return;
+        }
+
+        data = realloc(out->data, out->size * 2 + len);
+        if (!data) {
+            out->failed = true;
+            return;
+        }
+        out->data = data;
+        out->size = out->size * 2 + len;
+    }
+}
+
+static void
+symbolize(const ejElfInfo *info, char *addr_list, struct output *out)
+{
+    size_t count = 1;
+    ejAddr *addrs;
+    ejSymbolization *results;
+
+    for (const char *c = addr_list; *c; c++) {
+        count += (*c == ',');
+    }
+
+    addrs = malloc(sizeof(*addrs) * count);
+    results = malloc(sizeof(*results) * count);
+    if (!addrs || !results) {
+        appendf(out, "! %s\n", strerror(ENOMEM));
+        goto done;
+    }
+
+    for (size_t k = 0; k < count; k++) {
+        addrs[k] = strtoull(addr_list, &addr_list, 0);
+        addr_list += (*addr_list == ',');
+    }
+
+    if (ejSymbolizeBatch(info, addrs, count, results) != EJ_RET_OK) {
+        appendf(out, "! %s\n", ejGetError());
+        goto done;
+    }
+
+    for (size_t k = 0; k < count; k++) {
+        if (results[k].name) {
+            appendf(out, "%s%s+0x%llx", (k == 0) ? "" : " ", results[k].name, results[k].offset);
+        }
+        else {
+            appendf(out, "%s?", (k == 0) ? "" : " ");
+        }
+    }
+    appendf(out, "\n");
+
+done:
+    free(addrs);
+    free(results);
+}
+
+/*
+ * Splits "<command> <length>:<argument> <path>" in place.
+ */
+static bool
+parseRequest(char *line, char **argument, char **path)
+{
+    char *end;
+    unsigned long len;
+
+    if ((line[0] != 'F' && line[0] != 'G' && line[0] != 'S') || line[1] != ' ' || line[2] < '0' ||
+        line[2] > '9') {
+        return false;
+    }
+
+    len = strtoul(line + 2, &end, 10);
+    if (*end != ':' || len == 0 || len >= strlen(end + 1)) {
+        return false;
+    }
+
+    *argument = end + 1;
+    *path = *argument + len;
+    if (**path != ' ' || (*path)[1] == '\0') {
+        return false;
+    }
+    *(*path)++ = '\0';
+    return true;
+}
+
+static void
+handleRequest(char *line, struct output *out)
+{
+    char *argument, *path;
+    const char *error;
+    const ejElfInfo *info;
+    ejAddr addr;
+
+    if (!parseRequest(line, &argument, &path)) {
+        appendf(out, "! bad request\n");
+        return;
+    }
+
+    info = lookupFile(path, &error);
+    if (!info) {
+        appendf(out, "! %s\n", error);
+        return;
+    }
+
+    if (line[0] == 'S') {
+        symbolize(info, argument, out);
+        return;
+    }
+
+    addr = (line[0] == 'F') ? ejFindFunction(info, argument) : ejFindGotEntry(info, argument);
+    if (addr == EJ_ADDR_NOT_FOUND) {
+        appendf(out, "! not found\n");
+    }
+    else {
+        appendf(out, "0x%llx\n", addr);
+    }
+}
+
+/*
+ * Sends as much pending output as the socket accepts without blocking so that a slow reader can't stall the
+ * other clients.  Returns false if the client should be disconnected.
+ */
+static bool
+flushClient(struct client *client)
+{
+    while (client->sent < client->out.used) {
+        ssize_t count;
+
+        count = send(client->fd, client->out.data + client->sent, client->out.used - client->sent,
+                     MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        client->sent += count;
+    }
+
+    client->out.used = 0;
+    client->sent = 0;
+    return true;
+}
+
+/*
+ * Answers every complete line that has arrived.  Returns false if the client should be disconnected.
+ */
+static bool
+serveClient(struct client *client)
+{
+    ssize_t count;
+    size_t consumed = 0;
+    bool ok = true;
+    struct output *out = &client->out;
+
+    count = recv(client->fd, client->buffer + client->used, sizeof(client->buffer) - client->used, 0);
+    if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+        return true;
+    }
+    if (count <= 0) {
+        return false;
+    }
+    client->used += count;
+
+    for (;;) {
+        char *newline = memchr(client->buffer + consumed, '\n', client->used - consumed);
+
+        if (!newline) {
+            break;
+        }
+        *newline = '\0';
+        handleRequest(client->buffer + consumed, out);
+        if (out->failed) {
+            return false;
+        }
+        consumed = newline + 1 - client->buffer;
+    }
+
+    memmove(client->buffer, client->buffer + consumed, client->used - consumed);
+    client->used -= consumed;
+    if (client->used == sizeof(client->buffer)) {
+        appendf(out, "! request too long\n");
+        ok = false;
+    }
+
+    return flushClient(client) && ok;
+}
+
+static int
+listenOn(const char *socket_path)
+{
+    int fd;
+    struct sockaddr_un addr = {.sun_family = AF_UNIX};
+
+    if (strlen(socket_path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "Socket path is too long\n");
+        return -1;
+    }
+    strcpy(addr.sun_path, socket_path);
+
+    fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        perror("socket");
+        return -1;
+    }
+
+    unlink(socket_path);
+    if (bind(fd, (const struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(fd, SOMAXCONN) != 0) {
+        perror("bind");
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+int
+main(int argc, char **argv)
+{
+    int listen_fd;
+    const char *executable = argv[0];
+    struct sigaction action = {.sa_handler = handleSignal};
+    struct pollfd fds[MAX_CLIENTS + 2];
+
+    if (argc != 2) {
+        usage(executable);
+        return EJ_RET_BAD_USAGE;
+    }
+    if (strcmp(argv[1], "-h") == 0 || strcmp(argv[1], "--help") == 0) {
+        usage(executable);
+        return 0;
+    }
+
+    inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify_fd < 0) {
+        perror("inotify_init1");
+        return 1;
+    }
+    listen_fd = listenOn(argv[1]);
+    if (listen_fd < 0) {
+        return 1;
+    }
+
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    signal(SIGPIPE, SIG_IGN);
+    for (unsigned int k = 0; k < MAX_CLIENTS; k++) {
+        clients[k].fd = -1;
+        clients[k].out.size = EJD_MAX_LINE;
+        clients[k].out.data = malloc(clients[k].out.size);
+        if (!clients[k].out.data) {
+            perror("malloc");
+            return 1;
+        }
+    }
+
+    while (!stopping) {
+        unsigned int num_fds = 2;
+
+        fds[0] = (struct pollfd){.fd = listen_fd, .events = POLLIN};
+        fds[1] = (struct pollfd){.fd = inotify_fd, .events = POLLIN};
+        for (unsigned int k = 0; k < MAX_CLIENTS; k++) {
+            if (clients[k].fd >= 0) {
+                short events = (clients[k].sent < clients[k].out.used) ? POLLOUT : POLLIN;
+
+                fds[num_fds++] = (struct pollfd){.fd = clients[k].fd, .events = events};
+            }
+        }
+
+        if (poll(fds, num_fds, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("poll");
+            break;
+        }
+
+        // Invalidate before answering so that no request is served from a stale parse.
+        if (fds[1].revents & POLLIN) {
+            drainInotify();
+        }
+
+        for (unsigned int k = 2; k < num_fds; k++) {
+            struct client *client = NULL;
+
+            if (!fds[k].revents) {
+                continue;
+            }
+            for (unsigned int j = 0; j < MAX_CLIENTS; j++) {
+                if (clients[j].fd == fds[k].fd) {
+                    client = &clients[j];
+                    break;
+                }
+            }
+            if (!((fds[k].events & POLLOUT) ? flushClient(client) : serveClient(client))) {
+                close(client->fd);
+                client->fd = -1;
+            }
+        }
+
+        if (fds[0].revents & POLLIN) {
+            int fd = accept(listen_fd, NULL, NULL);
+
+            if (fd >= 0 && fcntl(fd, F_SETFL, O_NONBLOCK) != 0) {
+                close(fd);
+            }
+            else if (fd >= 0) {
+                unsigned int k;
+
+                for (k = 0; k < MAX_CLIENTS && clients[k].fd >= 0; k++) {
+                }
+                if (k == MAX_CLIENTS) {
+                    close(fd);
+                }
+                else {
+                    clients[k].fd = fd;
+                    clients[k].used = 0;
+                    clients[k].out.used = 0;
+                    clients[k].out.failed = false;
+                    clients[k].sent = 0;
+                }
+            }
+        }
+    }
+
+    for (unsigned int k = 0; k < MAX_CLIENTS; k++) {
+        if (clients[k].fd >= 0) {
+            close(clients[k].fd);
+        }
+        free(clients[k].out.data);
+    }
+    for (unsigned int k = 0; k < NUM_BUCKETS; k++) {
+        while (buckets[k]) {
+            struct cachedFile *file = buckets[k];
+
+            buckets[k] = file->next;
+            ejReleaseInfo(&file->info);
+            free(file);
+        }
+    }
+    close(listen_fd);
+    unlink(argv[1]);
+    return 0;
+}
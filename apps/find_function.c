@@ -3,17 +3,20 @@
 
 #include <elfjack/elfjack.h>
 
+#include "daemon_client.h"
+
 static void
 usage(const char *executable)
 {
-    fprintf(stderr, "Usage: %s [path to elf] [function name]", executable);
+    fprintf(stderr, "Usage: %s [-d] [-s socket] [path to elf] [function name]", executable);
 }
 
 int
 main(int argc, char **argv)
 {
     int ret;
-    const char *executable = argv[0], *function_name;
+    unsigned int flags = 0;
+    const char *executable = argv[0], *function_name, *socket_path = NULL;
     ejAddr addr;
     ejElfInfo info;
 
@@ -27,12 +30,34 @@ main(int argc, char **argv)
         return 0;
     }
 
+    // Searching for a separate debug file costs a few extra lookups and a mapping, so it's opt-in.
+    if (strcmp(argv[1], "-d") == 0) {
+        flags |= EJ_PARSE_DEBUGINFO;
+        argc--;
+        argv++;
+    }
+
+    if (argc >= 2 && strcmp(argv[1], "-s") == 0) {
+        if (argc < 3) {
+            usage(executable);
+            return EJ_RET_BAD_USAGE;
+        }
+        socket_path = argv[2];
+        argc -= 2;
+        argv += 2;
+    }
+
     if (argc != 3) {
         usage(executable);
         return EJ_RET_BAD_USAGE;
     }
 
-    ret = ejParseElf(argv[1], &info);
+    if (socket_path) {
+        ret = ejdLookup(socket_path, 'F', argv[1], argv[2]);
+        return (ret < 0) ? EJ_RET_READ_FAILURE : ret;
+    }
+
+    ret = ejParseElfWithFlags(argv[1], &info, flags);
     if (ret != EJ_RET_OK) {
         fprintf(stderr, "Failed to parse ELF file: %s\n", ejGetError());
         return ret;
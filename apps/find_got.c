@@ -3,17 +3,19 @@
 
 #include <elfjack/elfjack.h>
 
+#include "daemon_client.h"
+
 static void
 usage(const char *executable)
 {
-    fprintf(stderr, "Usage: %s [path to elf] [function name]", executable);
+    fprintf(stderr, "Usage: %s [-s socket] [path to elf] [function name]", executable);
 }
 
 int
 main(int argc, char **argv)
 {
     int ret;
-    const char *executable = argv[0], *function_name;
+    const char *executable = argv[0], *function_name, *socket_path = NULL;
     ejAddr addr;
     ejElfInfo info;
 
@@ -27,11 +29,26 @@ main(int argc, char **argv)
         return 0;
     }
 
+    if (strcmp(argv[1], "-s") == 0) {
+        if (argc < 3) {
+            usage(executable);
+            return EJ_RET_BAD_USAGE;
+        }
+        socket_path = argv[2];
+        argc -= 2;
+        argv += 2;
+    }
+
     if (argc != 3) {
         usage(executable);
         return EJ_RET_BAD_USAGE;
     }
 
+    if (socket_path) {
+        ret = ejdLookup(socket_path, 'G', argv[1], argv[2]);
+        return (ret < 0) ? EJ_RET_READ_FAILURE : ret;
+    }
+
     ret = ejParseElf(argv[1], &info);
     if (ret != EJ_RET_OK) {
         fprintf(stderr, "Failed to parse ELF file: %s\n", ejGetError());
@@ -1,7 +1,7 @@
 APPS := $(patsubst $(APP_DIR)/%.c,%,$(wildcard $(APP_DIR)/*.c))
 
-%: $(APP_DIR)/%.c $(EJ_STATIC_LIBRARY)
-	$(CC) $(CFLAGS) $(EJ_INCLUDE_FLAGS) $^ -o $@
+%: $(APP_DIR)/%.c $(EJ_STATIC_LIBRARY) $(wildcard $(APP_DIR)/*.h)
+	$(CC) $(CFLAGS) $(EJ_INCLUDE_FLAGS) $(filter %.c %.a,$^) -ldl -o $@
 
 app_clean:
 	@rm -f $(APPS)
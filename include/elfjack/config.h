@@ -3,3 +3,7 @@
 #ifndef EJ_ERROR_BUFFER_SIZE
 #define EJ_ERROR_BUFFER_SIZE 256
 #endif
+
+#ifndef EJ_DEBUG_ROOT
+#define EJ_DEBUG_ROOT "/usr/lib/debug"
+#endif
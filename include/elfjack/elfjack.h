@@ -4,7 +4,7 @@
 #include <stdint.h>
 #include <sys/types.h>
 
-#define ELFJACK_VERSION "0.2.0"
+#define ELFJACK_VERSION "0.3.0"
 
 #if defined(__GNUC__) && !defined(EJ_NO_EXPORT)
 #define EJ_EXPORT __attribute__((visibility("default")))
@@ -26,6 +26,57 @@ enum ejRetValue {
     EJ_RET_NOT_ELF,
     EJ_RET_MISSING_INFO,
     EJ_RET_MALFORMED_ELF,
+    EJ_RET_OUT_OF_MEMORY,
+    EJ_RET_WRITE_FAILURE,
+    EJ_RET_NOT_ARCHIVE,
+};
+
+enum ejErrorCode {
+    EJ_ERR_NONE = 0,
+    EJ_ERR_NULL_ARGUMENT,
+    EJ_ERR_OPEN,
+    EJ_ERR_FSTAT,
+    EJ_ERR_MMAP,
+    EJ_ERR_NOT_ELF,
+    EJ_ERR_BAD_CLASS,
+    EJ_ERR_BAD_DATA,
+    EJ_ERR_BAD_TYPE,
+    EJ_ERR_BAD_SHSTRNDX,
+    EJ_ERR_EHDR_TRUNCATED,
+    EJ_ERR_SHDRS_TRUNCATED,
+    EJ_ERR_PHDRS_TRUNCATED,
+    EJ_ERR_NO_SHDRS,
+    EJ_ERR_NO_PHDRS,
+    EJ_ERR_NO_LOAD,
+    EJ_ERR_SECTION_TRUNCATED,
+    EJ_ERR_SECTION_EMPTY,
+    EJ_ERR_SECTION_UNTERMINATED,
+    EJ_ERR_SECTION_BAD_ENTSIZE,
+    EJ_ERR_SECTION_MISSING,
+    EJ_ERR_BAD_ENTSIZE,
+    EJ_ERR_OUT_OF_MEMORY,
+    EJ_ERR_MODULE_NOT_FOUND,
+    EJ_ERR_GOT_ENTRY_NOT_FOUND,
+    EJ_ERR_BAD_POINTER_SIZE,
+    EJ_ERR_PROCESS_VM_READV,
+    EJ_ERR_PROCESS_VM_WRITEV,
+    EJ_ERR_PARTIAL_TRANSFER,
+    EJ_ERR_NOT_ARCHIVE,
+    EJ_ERR_ARCHIVE_MALFORMED,
+    EJ_ERR_NOT_CORE,
+    EJ_ERR_NOTE_MALFORMED,
+    EJ_ERR_UNSUPPORTED_MACHINE,
+    EJ_ERR_FUNCTION_NOT_FOUND,
+    EJ_ERR_FUNCTION_NOT_MAPPED,
+};
+
+struct ejErrorInfo {
+    enum ejErrorCode code;
+    int errnum;
+    const char *section_name;
+    uint64_t section_index;
+    uint64_t offset;
+    uint64_t expected_size;
 };
 
 typedef unsigned long long ejAddr;
@@ -51,27 +102,130 @@ struct ejRelInfo {
     unsigned int info_offset;
 };
 
+struct ejSection {
+    uint64_t addr;
+    uint64_t offset;
+    uint64_t size;
+    uint64_t entsize;
+    uint64_t flags;
+    uint32_t name;
+    uint32_t type;
+    uint32_t link;
+    uint32_t info;
+};
+
+struct ejSegment {
+    uint64_t vaddr;
+    uint64_t offset;
+    uint64_t filesz;
+    uint64_t memsz;
+    uint32_t type;
+    uint32_t flags;
+};
+
+struct ejLayoutInfo {
+    struct ejSection *sections;
+    struct ejSegment *segments;
+    struct ejSegment *loads;
+    struct ejSegment *loads_by_offset;
+    const char *section_names;
+    uint64_t num_sections;
+    size_t section_names_size;
+    uint32_t num_segments;
+    uint32_t num_loads;
+};
+
+struct ejPltInfo {
+    ejAddr addr;
+    uint64_t size;
+    ejAddr sec_addr;
+    uint64_t sec_size;
+};
+
+struct ejGotInfo {
+    ejAddr addr;
+    uint64_t size;
+};
+
 struct ejIntHelpers {
     uint16_t (*get_u16)(const void *);
     uint32_t (*get_u32)(const void *);
     uint64_t (*get_u64)(const void *);
 };
 
+#define EJ_PARSE_DEBUGINFO 0x01
+
+enum ejStatsPhase {
+    EJ_PHASE_MAP = 0,
+    EJ_PHASE_HEADER,
+    EJ_PHASE_SECTIONS,
+    EJ_PHASE_SYMBOLS,
+    EJ_PHASE_RELOCATIONS,
+    EJ_PHASE_COUNT,
+};
+
+struct ejStats {
+    uint64_t parses;
+    uint64_t bytes_mapped;
+    uint64_t sections_scanned;
+    uint64_t symbols_compared;
+    uint64_t string_compares;
+    uint64_t relocations_scanned;
+    uint64_t cache_hits;
+    uint64_t cache_misses;
+    uint64_t phase_ns[EJ_PHASE_COUNT];
+};
+
 typedef union ejSymbolValue {
     ejAddr addr;
     uint64_t index;
 } ejSymbolValue;
 
+struct ejFunction {
+    ejAddr start;
+    uint64_t size;
+    const char *name;
+};
+
+struct ejGlobalFunction;
+struct ejFunctionIndex;
+struct ejDemangleIndex;
+struct ejGotIndex;
+
+typedef struct ejSymbolization {
+    const char *name;
+    ejAddr start;
+    ejAddr offset;
+} ejSymbolization;
+
 typedef struct ejElfInfo {
-    bool (*find_symbol)(const struct ejElfInfo *, const char *, uint16_t, ejSymbolValue *);
-    ejAddr (*find_got_entry)(const struct ejElfInfo *, uint64_t);
+    bool (*find_symbol)(const struct ejElfInfo *, const struct ejSymbolInfo *, const char *, uint32_t,
+                        ejSymbolValue *);
+    void (*index_got_slots)(const struct ejElfInfo *, const struct ejRelInfo *, struct ejGotIndex *);
+    uint64_t (*collect_functions)(const struct ejElfInfo *, const struct ejSymbolInfo *, struct ejFunction *);
+    uint64_t (*collect_globals)(const struct ejElfInfo *, const struct ejSymbolInfo *,
+                                struct ejGlobalFunction *);
     struct ejIntHelpers helpers;
     struct ejMapInfo map;
+    struct ejLayoutInfo layout;
     struct ejSymbolInfo symbols;
+    struct ejSymbolInfo full_symbols;
     struct ejRelInfo rels;
-    unsigned int load_bias;
-    uint16_t text_section_index;
+    struct ejRelInfo dyn_rels;
+    struct ejPltInfo plt;
+    struct ejGotInfo got;
+    struct ejElfInfo *debug_info;
+    struct ejFunctionIndex *function_index;
+    struct ejDemangleIndex *demangle_index;
+    struct ejGotIndex *got_index;
+    ejAddr load_bias;
+    ejAddr base_addr;
+    const uint32_t *gnu_hash;
+    uint32_t text_section_index;
     unsigned int dynamic : 1;
+    unsigned int in_process : 1;
+    unsigned int relocatable : 1;
+    unsigned int core : 1;
     struct {
         uint16_t machine;
         unsigned char pointer_size;
@@ -79,6 +233,88 @@ typedef struct ejElfInfo {
     } visible;
 } ejElfInfo;
 
+struct ejGotPatch {
+    const ejElfInfo *info;
+    ejAddr file_start;
+    const char *func_name;
+    ejAddr new_value;
+    ejAddr old_value;
+    ejAddr slot;
+    bool applied;
+};
+
+typedef struct ejArchive {
+    struct ejMapInfo map;
+    const unsigned char *symbol_offsets;
+    const char *symbol_names;
+    const char *long_names;
+    uint64_t num_symbols;
+    size_t symbol_names_size;
+    size_t long_names_size;
+    size_t first_member;
+    unsigned char offset_size;
+} ejArchive;
+
+typedef struct ejArchiveMember {
+    const char *name;
+    size_t name_size;
+    const void *data;
+    size_t size;
+    size_t next;
+} ejArchiveMember;
+
+typedef struct ejCoreModule {
+    const char *path;
+    ejAddr file_start;
+    ejElfInfo info;
+    bool parsed;
+} ejCoreModule;
+
+struct ejCoreMapping {
+    ejAddr start;
+    ejAddr end;
+    ejAddr offset;
+    size_t module;
+};
+
+typedef struct ejCoreThread {
+    uint32_t tid;
+    uint16_t signal;
+    ejAddr pc;
+} ejCoreThread;
+
+typedef struct ejCore {
+    ejElfInfo info;
+    ejCoreModule *modules;
+    struct ejCoreMapping *mappings;
+    ejCoreThread *threads;
+    size_t num_modules;
+    size_t num_mappings;
+    size_t num_threads;
+} ejCore;
+
+enum ejSymbolChangeKind {
+    EJ_SYMBOL_ADDED = 0,
+    EJ_SYMBOL_REMOVED,
+    EJ_SYMBOL_CHANGED,
+};
+
+typedef struct ejSymbolChange {
+    const char *name;
+    enum ejSymbolChangeKind kind;
+    ejAddr old_value;
+    ejAddr new_value;
+    uint64_t old_size;
+    uint64_t new_size;
+    ejAddr old_got;
+    ejAddr new_got;
+} ejSymbolChange;
+
+typedef struct ejSymbolDiff {
+    ejSymbolChange *changes;
+    size_t num_changes;
+} ejSymbolDiff;
+
 #define EJ_ELF_INFO_INIT \
     (ejElfInfo)          \
     {                    \
@@ -88,17 +324,90 @@ typedef struct ejElfInfo {
 int
 ejParseElf(const char *path, ejElfInfo *info) EJ_EXPORT;
 
+int
+ejParseElfWithFlags(const char *path, ejElfInfo *info, unsigned int flags) EJ_EXPORT;
+
+int
+ejParseElfMemory(const void *data, size_t size, ejElfInfo *info) EJ_EXPORT;
+
+int
+ejParseLoadedModule(const char *name, ejElfInfo *info) EJ_EXPORT;
+
 char *
-ejGetError(void) EJ_PURE EJ_EXPORT;
+ejGetError(void) EJ_EXPORT;
+
+const struct ejErrorInfo *
+ejGetErrorInfo(void) EJ_PURE EJ_EXPORT;
 
 void
 ejReleaseInfo(ejElfInfo *info) EJ_EXPORT;
 
 ejAddr
-ejFindGotEntry(const ejElfInfo *info, const char *func_name) EJ_EXPORT EJ_PURE;
+ejFindGotEntry(const ejElfInfo *info, const char *func_name) EJ_EXPORT;
+
+ejAddr
+ejFindFunction(const ejElfInfo *info, const char *func_name) EJ_EXPORT;
+
+ejAddr
+ejFindDemangledFunction(const ejElfInfo *info, const char *name) EJ_EXPORT;
+
+const void *
+ejGetFunctionBytes(const ejElfInfo *info, const char *func_name, size_t *size) EJ_EXPORT;
 
 ejAddr
-ejFindFunction(const ejElfInfo *info, const char *func_name) EJ_EXPORT EJ_PURE;
+ejFindPltEntry(const ejElfInfo *info, const char *func_name) EJ_EXPORT;
+
+int
+ejSymbolizeBatch(const ejElfInfo *info, const ejAddr *addrs, size_t count, ejSymbolization *out) EJ_EXPORT;
+
+int
+ejDiffSymbols(const ejElfInfo *old_info, const ejElfInfo *new_info, ejSymbolDiff *diff) EJ_EXPORT;
+
+void
+ejReleaseSymbolDiff(ejSymbolDiff *diff) EJ_EXPORT;
+
+int
+ejPatchGotEntries(pid_t pid, struct ejGotPatch *patches, size_t count) EJ_EXPORT;
+
+bool
+ejGetStats(struct ejStats *stats) EJ_EXPORT;
+
+void
+ejResetStats(void) EJ_EXPORT;
 
 ejAddr
 ejResolveAddress(const ejElfInfo *info, ejAddr addr, ejAddr file_start) EJ_EXPORT EJ_PURE;
+
+ejAddr
+ejUnresolveAddress(const ejElfInfo *info, ejAddr addr, ejAddr file_start) EJ_EXPORT EJ_PURE;
+
+ejAddr
+ejVaddrToOffset(const ejElfInfo *info, ejAddr vaddr) EJ_EXPORT EJ_PURE;
+
+ejAddr
+ejOffsetToVaddr(const ejElfInfo *info, ejAddr offset) EJ_EXPORT EJ_PURE;
+
+int
+ejOpenArchive(const char *path, ejArchive *archive) EJ_EXPORT;
+
+void
+ejCloseArchive(ejArchive *archive) EJ_EXPORT;
+
+bool
+ejNextArchiveMember(const ejArchive *archive, ejArchiveMember *member) EJ_EXPORT;
+
+bool
+ejFindArchiveMember(const ejArchive *archive, const char *symbol, ejArchiveMember *member) EJ_EXPORT;
+
+int
+ejParseCore(const char *path, ejCore *core, unsigned int flags) EJ_EXPORT;
+
+int
+ejSymbolizeCore(const ejCore *core, const ejAddr *addrs, size_t count, ejSymbolization *out,
+                const ejCoreModule **modules) EJ_EXPORT;
+
+int
+ejSymbolizeCoreThreads(const ejCore *core, ejSymbolization *out, const ejCoreModule **modules) EJ_EXPORT;
+
+void
+ejReleaseCore(ejCore *core) EJ_EXPORT;
@@ -32,7 +32,7 @@ endif
 
 $(EJ_SHARED_LIBRARY): $(EJ_OBJECT_FILES)
 	@mkdir -p $(@D)
-	$(CC) $(LDFLAGS) -shared -o $@ $^
+	$(CC) $(LDFLAGS) -shared -o $@ $^ -ldl
 
 $(EJ_STATIC_LIBRARY): $(EJ_OBJECT_FILES)
 	@mkdir -p $(@D)
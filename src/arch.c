@@ -0,0 +1,91 @@
+#include "internal.h"
+
+#ifndef EM_RISCV
+#define EM_RISCV 243
+#endif
+
+#ifndef R_RISCV_JUMP_SLOT
+#define R_RISCV_32        1
+#define R_RISCV_64        2
+#define R_RISCV_JUMP_SLOT 5
+#endif
+#ifndef R_RISCV_IRELATIVE
+#define R_RISCV_IRELATIVE 58
+#endif
+
+// PowerPC calls imported functions through stubs in .text (or .glink) rather than fixed-size PLT entries.
+static const struct ejArch arches[] = {
+    // machine, PC register, PLT header, PLT entry and .plt.sec entry sizes
+    {EM_X86_64, 16, 16, 16, 16}, // rip
+    {EM_386, 12, 16, 16, 16},    // eip
+    {EM_AARCH64, 32, 32, 16, 0}, // pc
+    {EM_ARM, 15, 20, 12, 0},     // r15
+    {EM_RISCV, 0, 32, 16, 0},    // pc
+    {EM_PPC64, 32, 0, 0, 0},     // nip
+    {EM_PPC, 32, 0, 0, 0},       // nip
+    {EM_S390, 1, 32, 32, 0},     // psw.addr
+};
+
+/*
+ * RISC-V has no GLOB_DAT type.  GOT entries are filled by the word-sized R_RISCV_64 or R_RISCV_32, which
+ * are also used for any other pointer in data, so they only count when they target .got.
+ */
+static const struct ejRelocTypes reloc_types[] = {
+    // machine, pointer size, JUMP_SLOT, GLOB_DAT, IRELATIVE, whether GLOB_DAT is generic
+    {EM_X86_64, 0, R_X86_64_JUMP_SLOT, R_X86_64_GLOB_DAT, R_X86_64_IRELATIVE, false},
+    {EM_386, 0, R_386_JMP_SLOT, R_386_GLOB_DAT, R_386_IRELATIVE, false},
+    {EM_AARCH64, 0, R_AARCH64_JUMP_SLOT, R_AARCH64_GLOB_DAT, R_AARCH64_IRELATIVE, false},
+    {EM_ARM, 0, R_ARM_JUMP_SLOT, R_ARM_GLOB_DAT, R_ARM_IRELATIVE, false},
+    {EM_RISCV, 8, R_RISCV_JUMP_SLOT, R_RISCV_64, R_RISCV_IRELATIVE, true},
+    {EM_RISCV, 4, R_RISCV_JUMP_SLOT, R_RISCV_32, R_RISCV_IRELATIVE, true},
+    {EM_PPC64, 0, R_PPC64_JMP_SLOT, R_PPC64_GLOB_DAT, R_PPC64_IRELATIVE, false},
+    {EM_PPC, 0, R_PPC_JMP_SLOT, R_PPC_GLOB_DAT, R_PPC_IRELATIVE, false},
+    {EM_S390, 0, R_390_JMP_SLOT, R_390_GLOB_DAT, R_390_IRELATIVE, false},
+};
+
+const struct ejArch *
+ejLookupArch(uint16_t machine)
+{
+    for (size_t k = 0; k < sizeof(arches) / sizeof(arches[0]); k++) {
+        if (arches[k].machine == machine) {
+            return &arches[k];
+        }
+    }
+
+    return NULL;
+}
+
+const struct ejRelocTypes *
+ejLookupRelocTypes(uint16_t machine, unsigned int pointer_size)
+{
+    for (size_t k = 0; k < sizeof(reloc_types) / sizeof(reloc_types[0]); k++) {
+        if (reloc_types[k].machine == machine &&
+            (reloc_types[k].pointer_size == 0 || reloc_types[k].pointer_size == pointer_size)) {
+            return &reloc_types[k];
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * offset is the relocation's r_offset.  Without a .got section (e.g., for in-process modules), GLOB_DAT
+ * relocations are trusted unless the type is a generic one.
+ */
+enum ejRelocationKind
+ejClassifyRelocation(const ejElfInfo *info, const struct ejRelocTypes *types, uint32_t type, ejAddr offset)
+{
+    if (type == types->jump_slot) {
+        return EJ_RELOC_JUMP_SLOT;
+    }
+    if (type == types->glob_dat) {
+        if (info->got.size > 0) {
+            return (offset - info->got.addr < info->got.size) ? EJ_RELOC_GLOB_DAT : EJ_RELOC_OTHER;
+        }
+        return types->generic_glob_dat ? EJ_RELOC_OTHER : EJ_RELOC_GLOB_DAT;
+    }
+    if (type == types->irelative) {
+        return EJ_RELOC_IRELATIVE;
+    }
+    return EJ_RELOC_OTHER;
+}
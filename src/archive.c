@@ -0,0 +1,247 @@
+#include <ar.h>
+#include <sys/mman.h>
+
+#include "internal.h"
+
+static uint64_t
+getBigEndian(const unsigned char *src, unsigned int size)
+{
+    uint64_t value = 0;
+
+    for (unsigned int k = 0; k < size; k++) {
+        value = (value << 8) | src[k];
+    }
+
+    return value;
+}
+
+/*
+ * Header fields are left-justified decimal numbers padded with spaces.
+ */
+static bool
+parseDecimal(const char *field, size_t size, uint64_t *value)
+{
+    size_t k;
+
+    *value = 0;
+    for (k = 0; k < size && field[k] >= '0' && field[k] <= '9'; k++) {
+        *value = *value * 10 + (field[k] - '0');
+    }
+
+    return k > 0 && (k == size || field[k] == ' ');
+}
+
+static bool
+malformed(size_t offset)
+{
+    ejSetSectionError(EJ_ERR_ARCHIVE_MALFORMED, NULL, 0, offset, sizeof(struct ar_hdr));
+    return false;
+}
+
+static bool
+readHeader(const ejArchive *archive, size_t offset, ejArchiveMember *member)
+{
+    uint64_t size;
+    const struct ar_hdr *header;
+
+    if (!RANGE_IN_MAP(&archive->map, offset, sizeof(*header))) {
+        return malformed(offset);
+    }
+    header = AT_OFFSET(archive->map.data, offset);
+    if (memcmp(header->ar_fmag, ARFMAG, sizeof(header->ar_fmag)) != 0 ||
+        !parseDecimal(header->ar_size, sizeof(header->ar_size), &size) ||
+        !RANGE_IN_MAP(&archive->map, offset + sizeof(*header), size)) {
+        return malformed(offset);
+    }
+
+    member->name = header->ar_name;
+    member->name_size = sizeof(header->ar_name);
+    member->data = header + 1;
+    member->size = size;
+    // Member data is padded to an even offset.
+    member->next = offset + sizeof(*header) + size + (size & 1);
+    return true;
+}
+
+static bool
+resolveName(const ejArchive *archive, size_t offset, ejArchiveMember *member)
+{
+    uint64_t value;
+    const char *name = member->name, *end;
+
+    if (name[0] == '/' && name[1] >= '0' && name[1] <= '9') {
+        // GNU long name: an offset into the "//" member where the name is terminated by "/\n".
+        if (!archive->long_names || !parseDecimal(name + 1, member->name_size - 1, &value) ||
+            value >= archive->long_names_size) {
+            return malformed(offset);
+        }
+        member->name = archive->long_names + value;
+        end = memchr(member->name, '\n', archive->long_names_size - value);
+        member->name_size = end ? (size_t)(end - member->name) : archive->long_names_size - value;
+    }
+    else if (memcmp(name, "#1/", 3) == 0) {
+        // BSD long name: the name occupies the start of the member's data.
+        if (!parseDecimal(name + 3, member->name_size - 3, &value) || value > member->size) {
+            return malformed(offset);
+        }
+        member->name = member->data;
+        member->name_size = strnlen(member->name, value);
+        member->data = AT_OFFSET(member->data, value);
+        member->size -= value;
+        return true;
+    }
+    else {
+        while (member->name_size > 0 && name[member->name_size - 1] == ' ') {
+            member->name_size--;
+        }
+    }
+
+    if (member->name_size > 0 && member->name[member->name_size - 1] == '/') {
+        member->name_size--;
+    }
+    return true;
+}
+
+static bool
+readMember(const ejArchive *archive, size_t offset, ejArchiveMember *member)
+{
+    return readHeader(archive, offset, member) && resolveName(archive, offset, member);
+}
+
+static bool
+setSymbolTable(ejArchive *archive, const ejArchiveMember *member, unsigned int offset_size)
+{
+    uint64_t count;
+    const unsigned char *data = member->data;
+
+    if (member->size < offset_size) {
+        return false;
+    }
+    count = getBigEndian(data, offset_size);
+    if (count > member->size / offset_size - 1) {
+        return false;
+    }
+
+    archive->offset_size = offset_size;
+    archive->num_symbols = count;
+    archive->symbol_offsets = data + offset_size;
+    archive->symbol_names = (const char *)archive->symbol_offsets + count * offset_size;
+    archive->symbol_names_size = member->size - (count + 1) * offset_size;
+    return true;
+}
+
+int
+ejOpenArchive(const char *path, ejArchive *archive)
+{
+    int ret;
+    size_t offset;
+    ejArchiveMember member;
+
+    if (!path || !archive) {
+        ejSetError(EJ_ERR_NULL_ARGUMENT);
+        return EJ_RET_BAD_USAGE;
+    }
+
+    *archive = (ejArchive){0};
+    ret = ejMapFile(path, &archive->map);
+    if (ret != EJ_RET_OK) {
+        return ret;
+    }
+
+    if (archive->map.size < SARMAG || memcmp(archive->map.data, ARMAG, SARMAG) != 0) {
+        ejSetError(EJ_ERR_NOT_ARCHIVE);
+        ejCloseArchive(archive);
+        return EJ_RET_NOT_ARCHIVE;
+    }
+
+    // The symbol index and the long name table, when present, precede the regular members.
+    for (offset = SARMAG; offset < archive->map.size; offset = member.next) {
+        if (!readHeader(archive, offset, &member)) {
+            ejCloseArchive(archive);
+            return EJ_RET_MALFORMED_ELF;
+        }
+
+        if (memcmp(member.name, "/ ", 2) == 0 || memcmp(member.name, "/SYM64/ ", 8) == 0) {
+            if (!setSymbolTable(archive, &member, (member.name[1] == ' ') ? 4 : 8)) {
+                malformed(offset);
+                ejCloseArchive(archive);
+                return EJ_RET_MALFORMED_ELF;
+            }
+        }
+        else if (memcmp(member.name, "// ", 3) == 0) {
+            archive->long_names = member.data;
+            archive->long_names_size = member.size;
+        }
+        else {
+            break;
+        }
+    }
+    archive->first_member = offset;
+
+    return EJ_RET_OK;
+}
+
+void
+ejCloseArchive(ejArchive *archive)
+{
+    if (!archive) {
+        return;
+    }
+
+    if (archive->map.data) {
+        munmap((void *)archive->map.data, archive->map.map_size);
+    }
+    *archive = (ejArchive){0};
+}
+
+bool
+ejNextArchiveMember(const ejArchive *archive, ejArchiveMember *member)
+{
+    size_t offset;
+
+    if (!archive || !archive->map.data || !member) {
+        ejSetError(EJ_ERR_NULL_ARGUMENT);
+        return false;
+    }
+
+    offset = (member->next == 0) ? archive->first_member : member->next;
+    if (offset >= archive->map.size) {
+        return false;
+    }
+    return readMember(archive, offset, member);
+}
+
+bool
+ejFindArchiveMember(const ejArchive *archive, const char *symbol, ejArchiveMember *member)
+{
+    size_t symbol_len, remaining;
+    const char *name;
+
+    if (!archive || !archive->map.data || !symbol || !member) {
+        ejSetError(EJ_ERR_NULL_ARGUMENT);
+        return false;
+    }
+
+    symbol_len = strlen(symbol);
+    name = archive->symbol_names;
+    remaining = archive->symbol_names_size;
+    for (uint64_t k = 0; k < archive->num_symbols && remaining > 0; k++) {
+        size_t len = strnlen(name, remaining);
+
+        EJ_STAT_INC(string_compares);
+        if (len == symbol_len && memcmp(name, symbol, len) == 0) {
+            return readMember(archive,
+                              getBigEndian(archive->symbol_offsets + k * archive->offset_size,
+                                           archive->offset_size),
+                              member);
+        }
+
+        if (len == remaining) {
+            break;
+        }
+        name += len + 1;
+        remaining -= len + 1;
+    }
+
+    return false;
+}
@@ -0,0 +1,87 @@
+#include "internal.h"
+
+const void *
+ejGetFunctionBytes(const ejElfInfo *info, const char *func_name, size_t *size)
+{
+    ejAddr addr, offset;
+    const struct ejFunction *function;
+
+    if (!INFO_INITIALIZED(info) || !func_name || !size) {
+        ejSetError(EJ_ERR_NULL_ARGUMENT);
+        return NULL;
+    }
+
+    addr = ejFindFunction(info, func_name);
+    if (addr == EJ_ADDR_NOT_FOUND) {
+        ejSetError(EJ_ERR_FUNCTION_NOT_FOUND);
+        return NULL;
+    }
+
+    function = ejLookupFunction(info, addr);
+    *size = function ? function->size : 0;
+    if (info->in_process) {
+        return (const void *)(uintptr_t)addr;
+    }
+
+    // Addresses in relocatable objects are already file offsets.
+    offset = info->relocatable ? addr : ejVaddrToOffset(info, addr);
+    if (offset == EJ_ADDR_NOT_FOUND || !RANGE_IN_MAP(&info->map, offset, *size) ||
+        (!info->relocatable && *size > 0 && ejVaddrToOffset(info, addr + *size - 1) != offset + *size - 1)) {
+        ejSetSectionError(EJ_ERR_FUNCTION_NOT_MAPPED, NULL, 0, offset, *size);
+        return NULL;
+    }
+
+    return AT_OFFSET(info->map.data, offset);
+}
+
+/*
+ * Lazy-binding PLT stubs appear in the same order as their relocations in .rela.plt (or .rel.plt).  When
+ * .plt.sec is present (e.g., with Intel CET), calls go through it instead and it has no header.
+ */
+ejAddr
+ejFindPltEntry(const ejElfInfo *info, const char *func_name)
+{
+    uint64_t rel_index;
+    const struct ejArch *arch;
+    const struct ejGotSlot *slot = NULL;
+    ejSymbolValue value;
+
+    if (!INFO_INITIALIZED(info) || !func_name) {
+        ejSetError(EJ_ERR_NULL_ARGUMENT);
+        return EJ_ADDR_NOT_FOUND;
+    }
+
+    arch = ejLookupArch(info->visible.machine);
+    if (!arch || arch->plt_entry_size == 0) {
+        ejSetError(EJ_ERR_UNSUPPORTED_MACHINE);
+        return EJ_ADDR_NOT_FOUND;
+    }
+
+    // Functions bound through GLOB_DAT entries (e.g., with -fno-plt) have no PLT stub.
+    if (info->find_symbol(info, &info->symbols, func_name, 0, &value)) {
+        slot = ejLookupGotSlot(info, value.index);
+    }
+    if (!slot || slot->rel_index == EJ_NO_REL_INDEX) {
+        ejSetError(EJ_ERR_GOT_ENTRY_NOT_FOUND);
+        return EJ_ADDR_NOT_FOUND;
+    }
+    rel_index = slot->rel_index;
+
+    if (info->plt.sec_size > 0 && arch->plt_sec_entry_size > 0) {
+        if (rel_index < info->plt.sec_size / arch->plt_sec_entry_size) {
+            return info->plt.sec_addr + rel_index * arch->plt_sec_entry_size;
+        }
+    }
+    else if (info->plt.size > arch->plt_header_size) {
+        if (rel_index < (info->plt.size - arch->plt_header_size) / arch->plt_entry_size) {
+            return info->plt.addr + arch->plt_header_size + rel_index * arch->plt_entry_size;
+        }
+    }
+    else {
+        ejSetSectionError(EJ_ERR_SECTION_MISSING, ".plt", 0, 0, 0);
+        return EJ_ADDR_NOT_FOUND;
+    }
+
+    ejSetSectionError(EJ_ERR_SECTION_TRUNCATED, ".plt", 0, 0, 0);
+    return EJ_ADDR_NOT_FOUND;
+}
@@ -0,0 +1,445 @@
+#include <stdlib.h>
+
+#include "internal.h"
+
+#define ALIGN4(x) (((x) + 3) & ~(uint64_t)3)
+
+// Offsets of pr_pid and pr_reg within struct elf_prstatus, which is laid out identically on every
+// architecture for a given word size.
+#define PRSTATUS_CURSIG_OFFSET   12
+#define PRSTATUS_PID_OFFSET(_64) ((_64) ? 32 : 24)
+#define PRSTATUS_REG_OFFSET(_64) ((_64) ? 112 : 72)
+
+typedef int (*noteVisitor)(ejCore *, uint32_t, const unsigned char *, uint64_t);
+
+static uint64_t
+getWord(const ejElfInfo *info, const void *src)
+{
+    return (info->visible.pointer_size == 8) ? info->helpers.get_u64(src) : info->helpers.get_u32(src);
+}
+
+static int
+malformedNote(const char *note_name)
+{
+    ejSetSectionError(EJ_ERR_NOTE_MALFORMED, note_name, 0, 0, 0);
+    return EJ_RET_MALFORMED_ELF;
+}
+
+static int
+compareMappings(const void *a, const void *b)
+{
+    const struct ejCoreMapping *first = a, *second = b;
+
+    return (first->start > second->start) - (first->start < second->start);
+}
+
+/*
+ * Calls visit for every note named "CORE" in the core's PT_NOTE segments.
+ */
+static int
+walkNotes(ejCore *core, noteVisitor visit)
+{
+    const ejElfInfo *info = &core->info;
+
+    for (uint32_t k = 0; k < info->layout.num_segments; k++) {
+        const struct ejSegment *segment = &info->layout.segments[k];
+        const unsigned char *note;
+        uint64_t remaining;
+
+        if (segment->type != PT_NOTE) {
+            continue;
+        }
+        if (!RANGE_IN_MAP(&info->map, segment->offset, segment->filesz)) {
+            return malformedNote("PT_NOTE");
+        }
+
+        note = AT_OFFSET(info->map.data, segment->offset);
+        for (remaining = segment->filesz; remaining >= 12;) {
+            int ret;
+            uint32_t namesz, type;
+            uint64_t descsz, desc_offset, note_size;
+
+            namesz = info->helpers.get_u32(note);
+            descsz = info->helpers.get_u32(note + 4);
+            type = info->helpers.get_u32(note + 8);
+            desc_offset = 12 + ALIGN4((uint64_t)namesz);
+            note_size = desc_offset + ALIGN4(descsz);
+            if (desc_offset + descsz > remaining) {
+                return malformedNote("PT_NOTE");
+            }
+
+            if (namesz == sizeof("CORE") && memcmp(note + 12, "CORE", sizeof("CORE")) == 0) {
+                ret = visit(core, type, note + desc_offset, descsz);
+                if (ret != EJ_RET_OK) {
+                    return ret;
+                }
+            }
+
+            if (note_size >= remaining) {
+                break;
+            }
+            note += note_size;
+            remaining -= note_size;
+        }
+    }
+
+    return EJ_RET_OK;
+}
+
+static ejCoreModule *
+addModule(ejCore *core, const char *path)
+{
+    ejCoreModule *module;
+
+    // A file's mappings are almost always listed consecutively.
+    if (core->num_modules > 0 && strcmp(core->modules[core->num_modules - 1].path, path) == 0) {
+        return &core->modules[core->num_modules - 1];
+    }
+    for (size_t k = 0; k < core->num_modules; k++) {
+        if (strcmp(core->modules[k].path, path) == 0) {
+            return &core->modules[k];
+        }
+    }
+
+    module = &core->modules[core->num_modules++];
+    *module = (ejCoreModule){.path = path, .file_start = EJ_ADDR_NOT_FOUND, .info = EJ_ELF_INFO_INIT};
+    return module;
+}
+
+/*
+ * NT_FILE consists of a count, a page size, (start, end, page offset) triples, and then the file names.
+ */
+static int
+readFileNote(ejCore *core, const unsigned char *desc, uint64_t descsz)
+{
+    const ejElfInfo *info = &core->info;
+    unsigned int word = info->visible.pointer_size;
+    uint64_t count, page_size, names_size;
+    const char *names;
+
+    if (descsz < 2 * word) {
+        return malformedNote("NT_FILE");
+    }
+    count = getWord(info, desc);
+    page_size = getWord(info, desc + word);
+    if (count > (descsz - 2 * word) / (3 * word)) {
+        return malformedNote("NT_FILE");
+    }
+    names = (const char *)desc + (2 + 3 * count) * word;
+    names_size = descsz - (2 + 3 * count) * word;
+
+    core->mappings = malloc(sizeof(*core->mappings) * (count + 1));
+    core->modules = malloc(sizeof(*core->modules) * (count + 1));
+    if (!core->mappings || !core->modules) {
+        ejSetError(EJ_ERR_OUT_OF_MEMORY);
+        return EJ_RET_OUT_OF_MEMORY;
+    }
+
+    for (uint64_t k = 0; k < count; k++) {
+        const unsigned char *entry = desc + (2 + 3 * k) * word;
+        struct ejCoreMapping *mapping = &core->mappings[k];
+        ejCoreModule *module;
+        size_t len;
+
+        len = strnlen(names, names_size);
+        if (len == names_size) {
+            return malformedNote("NT_FILE");
+        }
+
+        module = addModule(core, names);
+        mapping->start = getWord(info, entry);
+        mapping->end = getWord(info, entry + word);
+        mapping->offset = getWord(info, entry + 2 * word) * page_size;
+        mapping->module = module - core->modules;
+        if (mapping->offset == 0 && mapping->start < module->file_start) {
+            module->file_start = mapping->start;
+        }
+
+        names += len + 1;
+        names_size -= len + 1;
+    }
+    core->num_mappings = count;
+
+    return EJ_RET_OK;
+}
+
+static int
+scanNote(ejCore *core, uint32_t type, const unsigned char *desc, uint64_t descsz)
+{
+    if (type == NT_PRSTATUS) {
+        core->num_threads++;
+    }
+    else if (type == NT_FILE && !core->mappings) {
+        return readFileNote(core, desc, descsz);
+    }
+
+    return EJ_RET_OK;
+}
+
+static int
+readThread(ejCore *core, uint32_t type, const unsigned char *desc, uint64_t descsz)
+{
+    const ejElfInfo *info = &core->info;
+    bool _64 = (info->visible.pointer_size == 8);
+    const struct ejArch *arch;
+    ejCoreThread *thread;
+    uint64_t pc_offset;
+
+    if (type != NT_PRSTATUS) {
+        return EJ_RET_OK;
+    }
+
+    arch = ejLookupArch(info->visible.machine);
+    if (!arch) {
+        ejSetError(EJ_ERR_UNSUPPORTED_MACHINE);
+        return EJ_RET_MISSING_INFO;
+    }
+
+    pc_offset = PRSTATUS_REG_OFFSET(_64) + (uint64_t)arch->pc_register * info->visible.pointer_size;
+    if (pc_offset + info->visible.pointer_size > descsz) {
+        return malformedNote("NT_PRSTATUS");
+    }
+
+    thread = &core->threads[core->num_threads++];
+    thread->tid = info->helpers.get_u32(desc + PRSTATUS_PID_OFFSET(_64));
+    thread->signal = info->helpers.get_u16(desc + PRSTATUS_CURSIG_OFFSET);
+    thread->pc = getWord(info, desc + pc_offset);
+    return EJ_RET_OK;
+}
+
+static void
+parseModules(ejCore *core, unsigned int flags)
+{
+    for (size_t k = 0; k < core->num_modules; k++) {
+        ejCoreModule *module = &core->modules[k];
+
+        module->parsed = (ejParseElfWithFlags(module->path, &module->info, flags) == EJ_RET_OK);
+    }
+
+    // Fall back to the lowest mapping for modules whose first page wasn't mapped.
+    for (size_t k = 0; k < core->num_mappings; k++) {
+        const struct ejCoreMapping *mapping = &core->mappings[k];
+        ejCoreModule *module = &core->modules[mapping->module];
+
+        if (module->file_start == EJ_ADDR_NOT_FOUND) {
+            module->file_start = mapping->start - mapping->offset;
+        }
+    }
+}
+
+int
+ejParseCore(const char *path, ejCore *core, unsigned int flags)
+{
+    int ret;
+    struct debugRefs refs = {0};
+
+    if (!path || !core) {
+        ejSetError(EJ_ERR_NULL_ARGUMENT);
+        return EJ_RET_BAD_USAGE;
+    }
+
+    *core = (ejCore){.info = EJ_ELF_INFO_INIT};
+    ret = ejMapFile(path, &core->info.map);
+    if (ret != EJ_RET_OK) {
+        return ret;
+    }
+
+    ret = ejParseImage(&core->info, &refs);
+    if (ret != EJ_RET_OK) {
+        goto error;
+    }
+    if (!core->info.core) {
+        ejSetError(EJ_ERR_NOT_CORE);
+        ret = EJ_RET_NOT_ELF;
+        goto error;
+    }
+
+    ret = walkNotes(core, scanNote);
+    if (ret != EJ_RET_OK) {
+        goto error;
+    }
+    if (!core->mappings) {
+        ejSetSectionError(EJ_ERR_SECTION_MISSING, "NT_FILE", 0, 0, 0);
+        ret = EJ_RET_MISSING_INFO;
+        goto error;
+    }
+
+    if (core->num_threads > 0) {
+        core->threads = malloc(sizeof(*core->threads) * core->num_threads);
+        if (!core->threads) {
+            ejSetError(EJ_ERR_OUT_OF_MEMORY);
+            ret = EJ_RET_OUT_OF_MEMORY;
+            goto error;
+        }
+        core->num_threads = 0;
+        ret = walkNotes(core, readThread);
+        if (ret != EJ_RET_OK) {
+            goto error;
+        }
+    }
+
+    qsort(core->mappings, core->num_mappings, sizeof(*core->mappings), compareMappings);
+    parseModules(core, flags);
+    return EJ_RET_OK;
+
+error:
+    ejReleaseCore(core);
+    return ret;
+}
+
+static const struct ejCoreMapping *
+findMapping(const ejCore *core, ejAddr addr)
+{
+    size_t low = 0, high = core->num_mappings;
+
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+
+        if (core->mappings[middle].start <= addr) {
+            low = middle + 1;
+        }
+        else {
+            high = middle;
+        }
+    }
+
+    if (low == 0 || addr >= core->mappings[low - 1].end) {
+        return NULL;
+    }
+    return &core->mappings[low - 1];
+}
+
+int
+ejSymbolizeCore(const ejCore *core, const ejAddr *addrs, size_t count, ejSymbolization *out,
+                const ejCoreModule **modules)
+{
+    int ret = EJ_RET_OK;
+    size_t none;
+    size_t *owners, *order, *starts;
+    ejAddr *relative;
+    ejSymbolization *results;
+
+    if (!core || !core->info.map.data || (count > 0 && (!addrs || !out))) {
+        ejSetError(EJ_ERR_NULL_ARGUMENT);
+        return EJ_RET_BAD_USAGE;
+    }
+
+    // Addresses are bucketed by module (with one extra bucket for those outside any parsed module) so that
+    // each module is symbolized with a single batch.
+    none = core->num_modules;
+    owners = malloc(sizeof(*owners) * count);
+    order = malloc(sizeof(*order) * count);
+    relative = malloc(sizeof(*relative) * count);
+    results = malloc(sizeof(*results) * count);
+    starts = calloc(none + 2, sizeof(*starts));
+    if ((count > 0 && (!owners || !order || !relative || !results)) || !starts) {
+        ejSetError(EJ_ERR_OUT_OF_MEMORY);
+        ret = EJ_RET_OUT_OF_MEMORY;
+        goto done;
+    }
+
+    for (size_t k = 0; k < count; k++) {
+        const struct ejCoreMapping *mapping = findMapping(core, addrs[k]);
+
+        owners[k] = (mapping && core->modules[mapping->module].parsed) ? mapping->module : none;
+        starts[owners[k] + 1]++;
+    }
+    for (size_t k = 1; k <= none + 1; k++) {
+        starts[k] += starts[k - 1];
+    }
+    for (size_t k = 0; k < count; k++) {
+        size_t position = starts[owners[k]]++;
+
+        order[position] = k;
+        relative[position] = EJ_ADDR_NOT_FOUND;
+        if (owners[k] != none) {
+            const ejCoreModule *module = &core->modules[owners[k]];
+
+            relative[position] = ejUnresolveAddress(&module->info, addrs[k], module->file_start);
+        }
+    }
+
+    // The placement loop advanced each bucket's start to the following bucket's.
+    for (size_t k = 0, begin = 0; k < none; begin = starts[k++]) {
+        const ejCoreModule *module = &core->modules[k];
+
+        if (starts[k] == begin) {
+            continue;
+        }
+        ret = ejSymbolizeBatch(&module->info, relative + begin, starts[k] - begin, results + begin);
+        if (ret != EJ_RET_OK) {
+            goto done;
+        }
+        for (size_t j = begin; j < starts[k]; j++) {
+            if (results[j].name) {
+                results[j].start = ejResolveAddress(&module->info, results[j].start, module->file_start);
+            }
+        }
+    }
+
+    for (size_t k = 0; k < count; k++) {
+        size_t index = order[k];
+
+        if (owners[index] == none) {
+            out[index] = (ejSymbolization){0};
+        }
+        else {
+            out[index] = results[k];
+        }
+        if (modules) {
+            modules[index] = (owners[index] == none) ? NULL : &core->modules[owners[index]];
+        }
+    }
+
+done:
+    free(owners);
+    free(order);
+    free(relative);
+    free(results);
+    free(starts);
+    return ret;
+}
+
+int
+ejSymbolizeCoreThreads(const ejCore *core, ejSymbolization *out, const ejCoreModule **modules)
+{
+    int ret;
+    ejAddr *pcs;
+
+    if (!core || (core->num_threads > 0 && !out)) {
+        ejSetError(EJ_ERR_NULL_ARGUMENT);
+        return EJ_RET_BAD_USAGE;
+    }
+
+    pcs = malloc(sizeof(*pcs) * (core->num_threads + 1));
+    if (!pcs) {
+        ejSetError(EJ_ERR_OUT_OF_MEMORY);
+        return EJ_RET_OUT_OF_MEMORY;
+    }
+    for (size_t k = 0; k < core->num_threads; k++) {
+        pcs[k] = core->threads[k].pc;
+    }
+
+    ret = ejSymbolizeCore(core, pcs, core->num_threads, out, modules);
+    free(pcs);
+    return ret;
+}
+
+void
+ejReleaseCore(ejCore *core)
+{
+    if (!core) {
+        return;
+    }
+
+    for (size_t k = 0; k < core->num_modules; k++) {
+        if (core->modules[k].parsed) {
+            ejReleaseInfo(&core->modules[k].info);
+        }
+    }
+    free(core->modules);
+    free(core->mappings);
+    free(core->threads);
+    ejReleaseInfo(&core->info);
+    *core = (ejCore){.info = EJ_ELF_INFO_INIT};
+}
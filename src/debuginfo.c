@@ -0,0 +1,141 @@
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <elfjack/config.h>
+
+#include "internal.h"
+
+#define ALIGN4(x) (((x) + 3) & ~(uint64_t)3)
+
+static uint32_t
+debugLinkCrc(const unsigned char *data, size_t size)
+{
+    uint32_t crc = 0xffffffff;
+
+    for (size_t k = 0; k < size; k++) {
+        crc ^= data[k];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xedb88320 & -(crc & 1));
+        }
+    }
+
+    return ~crc;
+}
+
+static bool
+tryCompanion(ejElfInfo *info, const char *path, const struct debugRefs *refs, bool check_crc)
+{
+    ejElfInfo *debug_info;
+
+    debug_info = malloc(sizeof(*debug_info));
+    if (!debug_info) {
+        return false;
+    }
+
+    if (ejParseCompanion(path, debug_info) != EJ_RET_OK) {
+        free(debug_info);
+        return false;
+    }
+
+    if (debug_info->visible.pointer_size != info->visible.pointer_size ||
+        debug_info->visible.machine != info->visible.machine ||
+        (check_crc && debugLinkCrc(debug_info->map.data, debug_info->map.size) != refs->debuglink_crc)) {
+        ejReleaseInfo(debug_info);
+        free(debug_info);
+        return false;
+    }
+
+    info->debug_info = debug_info;
+    return true;
+}
+
+void
+ejRecordBuildId(const ejElfInfo *info, struct debugRefs *refs, const void *start, uint64_t size)
+{
+    uint32_t namesz, descsz;
+    uint64_t desc_offset;
+    const unsigned char *note = start;
+
+    if (size < 12) {
+        return;
+    }
+
+    namesz = info->helpers.get_u32(note);
+    descsz = info->helpers.get_u32(note + 4);
+    if (info->helpers.get_u32(note + 8) != NT_GNU_BUILD_ID || namesz != sizeof(ELF_NOTE_GNU) ||
+        memcmp(note + 12, ELF_NOTE_GNU, sizeof(ELF_NOTE_GNU)) != 0) {
+        return;
+    }
+
+    desc_offset = 12 + ALIGN4(namesz);
+    if (descsz == 0 || desc_offset + descsz > size) {
+        return;
+    }
+
+    refs->build_id = note + desc_offset;
+    refs->build_id_size = descsz;
+}
+
+void
+ejRecordDebugLink(const ejElfInfo *info, struct debugRefs *refs, const void *start, uint64_t size)
+{
+    size_t name_len;
+    const char *name = start;
+
+    name_len = strnlen(name, size);
+    if (name_len == 0 || ALIGN4(name_len + 1) + 4 > size) {
+        return;
+    }
+
+    refs->debuglink = name;
+    refs->debuglink_crc = info->helpers.get_u32(AT_OFFSET(start, ALIGN4(name_len + 1)));
+}
+
+void
+ejLoadDebugInfo(ejElfInfo *info, const char *path, const struct debugRefs *refs)
+{
+    int dir_len;
+    const char *slash;
+    char candidate[PATH_MAX];
+
+    if (refs->build_id && refs->build_id_size > 1) {
+        int len;
+
+        len = snprintf(candidate, sizeof(candidate), "%s/.build-id/%02x/", EJ_DEBUG_ROOT, refs->build_id[0]);
+        for (size_t k = 1; k < refs->build_id_size && len + 3 < (int)sizeof(candidate); k++) {
+            len += snprintf(candidate + len, sizeof(candidate) - len, "%02x", refs->build_id[k]);
+        }
+        if (len + 6 < (int)sizeof(candidate)) {
+            strcpy(candidate + len, ".debug");
+            if (tryCompanion(info, candidate, refs, false)) {
+                return;
+            }
+        }
+    }
+
+    if (!refs->debuglink) {
+        return;
+    }
+
+    slash = strrchr(path, '/');
+    dir_len = slash ? (int)(slash - path) : 1;
+    if (!slash) {
+        path = ".";
+    }
+
+    if (snprintf(candidate, sizeof(candidate), "%.*s/%s", dir_len, path, refs->debuglink) <
+            (int)sizeof(candidate) &&
+        tryCompanion(info, candidate, refs, true)) {
+        return;
+    }
+    if (snprintf(candidate, sizeof(candidate), "%.*s/.debug/%s", dir_len, path, refs->debuglink) <
+            (int)sizeof(candidate) &&
+        tryCompanion(info, candidate, refs, true)) {
+        return;
+    }
+    if (snprintf(candidate, sizeof(candidate), "%s/%.*s/%s", EJ_DEBUG_ROOT, dir_len, path, refs->debuglink) <
+        (int)sizeof(candidate)) {
+        tryCompanion(info, candidate, refs, true);
+    }
+}
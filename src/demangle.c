@@ -0,0 +1,355 @@
+#define _GNU_SOURCE
+#include <dlfcn.h>
+#include <stdlib.h>
+
+#include "internal.h"
+
+#define FNV_OFFSET 0xcbf29ce484222325ULL
+#define FNV_PRIME  0x100000001b3ULL
+
+typedef char *(*demangleFunc)(const char *, char *, size_t *, int *);
+
+struct demangledName {
+    size_t name;
+    size_t qualified_start;
+    size_t qualified_size;
+    ejAddr addr;
+};
+
+struct demangleSlot {
+    uint64_t hash;
+    // (name index << 1 | is the qualified key) + 1, or 0 if the slot is empty.
+    uint64_t value;
+};
+
+struct ejDemangleIndex {
+    struct demangledName *names;
+    char *strings;
+    struct demangleSlot *slots;
+    size_t num_names;
+    size_t num_slots;
+};
+
+static demangleFunc
+getDemangler(void)
+{
+    static demangleFunc demangler;
+    static int resolved;
+    demangleFunc func;
+    void *handle;
+
+    if (__atomic_load_n(&resolved, __ATOMIC_ACQUIRE)) {
+        return __atomic_load_n(&demangler, __ATOMIC_RELAXED);
+    }
+
+    // Prefer a C++ runtime that's already loaded.  Otherwise, load libstdc++ without exposing its symbols.
+    func = (demangleFunc)dlsym(RTLD_DEFAULT, "__cxa_demangle");
+    if (!func) {
+        handle = dlopen("libstdc++.so.6", RTLD_LAZY | RTLD_LOCAL);
+        if (handle) {
+            func = (demangleFunc)dlsym(handle, "__cxa_demangle");
+        }
+    }
+
+    __atomic_store_n(&demangler, func, __ATOMIC_RELAXED);
+    __atomic_store_n(&resolved, 1, __ATOMIC_RELEASE);
+    return func;
+}
+
+static uint64_t
+hashBytes(const char *data, size_t size)
+{
+    uint64_t hash = FNV_OFFSET;
+
+    for (size_t k = 0; k < size; k++) {
+        hash = (hash ^ (unsigned char)data[k]) * FNV_PRIME;
+    }
+
+    return hash;
+}
+
+/*
+ * Finds the qualified name within a demangled function signature by stripping the parameter list (and
+ * anything after it) as well as the return type which template functions carry.  E.g., "void
+ * ns::f<int>(int) const" yields "ns::f<int>".
+ */
+static void
+findQualifiedName(const char *name, size_t size, size_t *start, size_t *qualified_size)
+{
+    size_t end = size, open;
+    int depth = 0;
+
+    *start = 0;
+    *qualified_size = size;
+
+    while (end > 0 && name[end - 1] != ')') {
+        end--;
+    }
+    if (end == 0) {
+        return;
+    }
+
+    for (open = end; open > 0; open--) {
+        if (name[open - 1] == ')') {
+            depth++;
+        }
+        else if (name[open - 1] == '(' && --depth == 0) {
+            break;
+        }
+    }
+    if (open <= 1) {
+        return;
+    }
+    open--;
+
+    // Spaces inside template arguments and "(anonymous namespace)" don't separate the return type.
+    depth = 0;
+    for (size_t k = open, parens = 0; k > 0; k--) {
+        char c = name[k - 1];
+
+        if (c == '>') {
+            depth++;
+        }
+        else if (c == '<' && --depth < 0) {
+            // Probably operator< or the like.
+            break;
+        }
+        else if (c == ')') {
+            parens++;
+        }
+        else if (c == '(' && parens > 0) {
+            parens--;
+        }
+        else if (c == ' ' && depth == 0 && parens == 0) {
+            *start = k;
+            break;
+        }
+    }
+
+    *qualified_size = open - *start;
+}
+
+static bool
+keyMatches(const struct ejDemangleIndex *index, uint64_t value, const char *key, size_t key_size)
+{
+    const struct demangledName *entry = &index->names[(value - 1) >> 1];
+    const char *name = index->strings + entry->name;
+
+    if ((value - 1) & 1) {
+        return entry->qualified_size == key_size && memcmp(name + entry->qualified_start, key, key_size) == 0;
+    }
+    return strncmp(name, key, key_size) == 0 && name[key_size] == '\0';
+}
+
+/*
+ * Returns the slot holding the key or the empty slot where it belongs.
+ */
+static struct demangleSlot *
+findSlot(const struct ejDemangleIndex *index, uint64_t hash, const char *key, size_t key_size)
+{
+    size_t mask = index->num_slots - 1;
+
+    for (size_t k = hash & mask;; k = (k + 1) & mask) {
+        struct demangleSlot *slot = &index->slots[k];
+
+        if (slot->value == 0) {
+            return slot;
+        }
+        EJ_STAT_INC(string_compares);
+        if (slot->hash == hash && keyMatches(index, slot->value, key, key_size)) {
+            return slot;
+        }
+    }
+}
+
+static void
+insertKey(struct ejDemangleIndex *index, const char *key, size_t key_size, uint64_t value)
+{
+    uint64_t hash = hashBytes(key, key_size);
+    struct demangleSlot *slot;
+
+    // The first definition of a name (i.e., the one from .dynsym) wins.
+    slot = findSlot(index, hash, key, key_size);
+    if (slot->value == 0) {
+        slot->hash = hash;
+        slot->value = value;
+    }
+}
+
+void
+ejFreeDemangleIndex(struct ejDemangleIndex *index)
+{
+    if (index) {
+        free(index->names);
+        free(index->strings);
+        free(index->slots);
+        free(index);
+    }
+}
+
+static uint64_t
+collectFunctions(const ejElfInfo *info, const struct ejSymbolInfo *symbols, struct ejFunction *functions)
+{
+    if (!symbols->start || !symbols->strings) {
+        return 0;
+    }
+    return info->collect_functions(info, symbols, functions);
+}
+
+static bool
+appendName(struct ejDemangleIndex *index, size_t *strings_size, size_t *strings_used, const char *demangled,
+           ejAddr addr)
+{
+    size_t len = strlen(demangled);
+    struct demangledName *entry = &index->names[index->num_names];
+
+    if (*strings_used + len + 1 > *strings_size) {
+        char *strings;
+        size_t new_size = (*strings_size + len + 1) * 2;
+
+        strings = realloc(index->strings, new_size);
+        if (!strings) {
+            return false;
+        }
+        index->strings = strings;
+        *strings_size = new_size;
+    }
+
+    memcpy(index->strings + *strings_used, demangled, len + 1);
+    entry->name = *strings_used;
+    entry->addr = addr;
+    findQualifiedName(demangled, len, &entry->qualified_start, &entry->qualified_size);
+    *strings_used += len + 1;
+    index->num_names++;
+    return true;
+}
+
+static struct ejDemangleIndex *
+buildDemangleIndex(const ejElfInfo *info)
+{
+    uint64_t upper_bound, count = 0;
+    size_t strings_size = 0, strings_used = 0, buffer_size = 256;
+    char *buffer = NULL;
+    struct ejFunction *functions = NULL;
+    struct ejDemangleIndex *index;
+    demangleFunc demangle;
+
+    index = calloc(1, sizeof(*index));
+    if (!index) {
+        return NULL;
+    }
+
+    demangle = getDemangler();
+    upper_bound = info->symbols.count + info->full_symbols.count;
+    if (info->debug_info) {
+        upper_bound += info->debug_info->full_symbols.count;
+    }
+
+    functions = malloc(sizeof(*functions) * (upper_bound + 1));
+    index->names = malloc(sizeof(*index->names) * (upper_bound + 1));
+    buffer = malloc(buffer_size);
+    if (!functions || !index->names || !buffer) {
+        goto error;
+    }
+
+    count += collectFunctions(info, &info->symbols, functions + count);
+    count += collectFunctions(info, &info->full_symbols, functions + count);
+    if (info->debug_info) {
+        count += collectFunctions(info->debug_info, &info->debug_info->full_symbols, functions + count);
+    }
+
+    for (uint64_t k = 0; k < count && demangle; k++) {
+        int status;
+        char *demangled;
+
+        if (strncmp(functions[k].name, "_Z", 2) != 0) {
+            continue;
+        }
+
+        // __cxa_demangle reuses (and grows) the buffer so that only one allocation is needed.
+        demangled = demangle(functions[k].name, buffer, &buffer_size, &status);
+        if (status != 0 || !demangled) {
+            continue;
+        }
+        buffer = demangled;
+
+        if (!appendName(index, &strings_size, &strings_used, demangled,
+                        functions[k].start + (info->in_process ? info->base_addr : 0))) {
+            goto error;
+        }
+    }
+
+    // Two keys (the full signature and the qualified name) per name at a load factor of at most 1/2.
+    index->num_slots = 4;
+    while (index->num_slots < index->num_names * 4) {
+        index->num_slots *= 2;
+    }
+    index->slots = calloc(index->num_slots, sizeof(*index->slots));
+    if (!index->slots) {
+        goto error;
+    }
+
+    for (size_t k = 0; k < index->num_names; k++) {
+        const struct demangledName *entry = &index->names[k];
+        const char *name = index->strings + entry->name;
+
+        insertKey(index, name, strlen(name), (k << 1) + 1);
+        if (entry->qualified_size != strlen(name)) {
+            insertKey(index, name + entry->qualified_start, entry->qualified_size, ((k << 1) | 1) + 1);
+        }
+    }
+
+    free(functions);
+    free(buffer);
+    return index;
+
+error:
+    free(functions);
+    free(buffer);
+    ejFreeDemangleIndex(index);
+    return NULL;
+}
+
+static const struct ejDemangleIndex *
+getDemangleIndex(const ejElfInfo *info)
+{
+    struct ejDemangleIndex *index, *expected = NULL;
+
+    index = EJ_LOAD_INDEX(info->demangle_index);
+    if (index) {
+        EJ_STAT_INC(cache_hits);
+        return index;
+    }
+    EJ_STAT_INC(cache_misses);
+
+    index = buildDemangleIndex(info);
+    if (index && !EJ_PUBLISH_INDEX(((ejElfInfo *)info)->demangle_index, expected, index)) {
+        ejFreeDemangleIndex(index);
+        index = expected;
+    }
+    return index;
+}
+
+ejAddr
+ejFindDemangledFunction(const ejElfInfo *info, const char *name)
+{
+    size_t size;
+    const struct ejDemangleIndex *index;
+    const struct demangleSlot *slot;
+
+    if (!INFO_INITIALIZED(info) || !name) {
+        return EJ_ADDR_NOT_FOUND;
+    }
+
+    index = getDemangleIndex(info);
+    if (!index) {
+        return EJ_ADDR_NOT_FOUND;
+    }
+
+    size = strlen(name);
+    slot = findSlot(index, hashBytes(name, size), name, size);
+    if (slot->value == 0) {
+        return EJ_ADDR_NOT_FOUND;
+    }
+    return index->names[(slot->value - 1) >> 1].addr;
+}
@@ -0,0 +1,179 @@
+#include <stdlib.h>
+
+#include "internal.h"
+
+struct symbolSet {
+    const ejElfInfo *info;
+    struct ejGlobalFunction *functions;
+    uint64_t count;
+    // Whether the functions come from the dynamic symbol table, which the GOT index refers to.
+    bool dynamic;
+};
+
+static int
+compareGlobals(const void *a, const void *b)
+{
+    int order;
+    const struct ejGlobalFunction *first = a, *second = b;
+
+    EJ_STAT_INC(string_compares);
+    order = strcmp(first->name, second->name);
+    if (order != 0) {
+        return order;
+    }
+    // Versioned symbols may share a name.  Pair them up by address.
+    return (first->value > second->value) - (first->value < second->value);
+}
+
+static ejAddr
+gotSlot(const struct symbolSet *set, const struct ejGlobalFunction *function)
+{
+    const struct ejGotSlot *slot;
+
+    if (!set->dynamic) {
+        return EJ_ADDR_NOT_FOUND;
+    }
+    slot = ejLookupGotSlot(set->info, function->index);
+    return slot ? slot->addr : EJ_ADDR_NOT_FOUND;
+}
+
+/*
+ * Collects the global functions of the dynamic symbol table (or of .symtab for a relocatable object) sorted
+ * by name.
+ */
+static int
+loadSymbolSet(const ejElfInfo *info, struct symbolSet *set)
+{
+    const struct ejSymbolInfo *symbols = info->symbols.start ? &info->symbols : &info->full_symbols;
+
+    *set = (struct symbolSet){.info = info, .dynamic = (symbols == &info->symbols)};
+    if (!symbols->start || !symbols->strings) {
+        return EJ_RET_OK;
+    }
+
+    set->functions = malloc(sizeof(*set->functions) * (symbols->count + 1));
+    if (!set->functions) {
+        ejSetError(EJ_ERR_OUT_OF_MEMORY);
+        return EJ_RET_OUT_OF_MEMORY;
+    }
+
+    set->count = info->collect_globals(info, symbols, set->functions);
+
+    if (info->in_process) {
+        // Imported functions have a value of 0.
+        for (uint64_t k = 0; k < set->count; k++) {
+            if (set->functions[k].value != 0) {
+                set->functions[k].value += info->base_addr;
+            }
+        }
+    }
+
+    qsort(set->functions, set->count, sizeof(*set->functions), compareGlobals);
+    return EJ_RET_OK;
+}
+
+static void
+addChange(ejSymbolDiff *diff, enum ejSymbolChangeKind kind, const struct symbolSet *old_set,
+          const struct ejGlobalFunction *old_function, const struct symbolSet *new_set,
+          const struct ejGlobalFunction *new_function)
+{
+    ejSymbolChange *change = &diff->changes[diff->num_changes++];
+
+    *change = (ejSymbolChange){.kind = kind,
+                               .old_value = EJ_ADDR_NOT_FOUND,
+                               .new_value = EJ_ADDR_NOT_FOUND,
+                               .old_got = EJ_ADDR_NOT_FOUND,
+                               .new_got = EJ_ADDR_NOT_FOUND};
+    if (old_function) {
+        change->name = old_function->name;
+        change->old_value = old_function->value;
+        change->old_size = old_function->size;
+        change->old_got = gotSlot(old_set, old_function);
+    }
+    if (new_function) {
+        change->name = new_function->name;
+        change->new_value = new_function->value;
+        change->new_size = new_function->size;
+        change->new_got = gotSlot(new_set, new_function);
+    }
+}
+
+int
+ejDiffSymbols(const ejElfInfo *old_info, const ejElfInfo *new_info, ejSymbolDiff *diff)
+{
+    int ret;
+    uint64_t old_pos = 0, new_pos = 0;
+    struct symbolSet old_set, new_set;
+
+    if (!INFO_INITIALIZED(old_info) || !INFO_INITIALIZED(new_info) || !diff) {
+        ejSetError(EJ_ERR_NULL_ARGUMENT);
+        return EJ_RET_BAD_USAGE;
+    }
+    *diff = (ejSymbolDiff){0};
+
+    ret = loadSymbolSet(old_info, &old_set);
+    if (ret != EJ_RET_OK) {
+        return ret;
+    }
+    ret = loadSymbolSet(new_info, &new_set);
+    if (ret != EJ_RET_OK) {
+        free(old_set.functions);
+        return ret;
+    }
+
+    diff->changes = malloc(sizeof(*diff->changes) * (old_set.count + new_set.count + 1));
+    if (!diff->changes) {
+        ejSetError(EJ_ERR_OUT_OF_MEMORY);
+        ret = EJ_RET_OUT_OF_MEMORY;
+        goto done;
+    }
+
+    // Both sets are sorted by name so a single merge pass pairs them up.
+    while (old_pos < old_set.count || new_pos < new_set.count) {
+        int order;
+        const struct ejGlobalFunction *old_function, *new_function;
+
+        old_function = (old_pos < old_set.count) ? &old_set.functions[old_pos] : NULL;
+        new_function = (new_pos < new_set.count) ? &new_set.functions[new_pos] : NULL;
+        if (!old_function) {
+            order = 1;
+        }
+        else if (!new_function) {
+            order = -1;
+        }
+        else {
+            EJ_STAT_INC(string_compares);
+            order = strcmp(old_function->name, new_function->name);
+        }
+
+        if (order < 0) {
+            addChange(diff, EJ_SYMBOL_REMOVED, &old_set, old_function, NULL, NULL);
+            old_pos++;
+        }
+        else if (order > 0) {
+            addChange(diff, EJ_SYMBOL_ADDED, NULL, NULL, &new_set, new_function);
+            new_pos++;
+        }
+        else {
+            if (old_function->value != new_function->value || old_function->size != new_function->size) {
+                addChange(diff, EJ_SYMBOL_CHANGED, &old_set, old_function, &new_set, new_function);
+            }
+            old_pos++;
+            new_pos++;
+        }
+    }
+
+done:
+    free(old_set.functions);
+    free(new_set.functions);
+    return ret;
+}
+
+void
+ejReleaseSymbolDiff(ejSymbolDiff *diff)
+{
+    if (diff) {
+        free(diff->changes);
+        *diff = (ejSymbolDiff){0};
+    }
+}
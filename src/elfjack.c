@@ -1,5 +1,6 @@
 #include <fcntl.h>
 #include <stddef.h>
+#include <stdlib.h>
 #include <string.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
@@ -9,8 +10,6 @@
 #include "parse32.h"
 #include "parse64.h"
 
-#define INFO_INITIALIZED(info) ((info) && (info)->map.data)
-
 static uint16_t
 getBigU16(const void *src)
 {
@@ -106,19 +105,18 @@ roundUpToPageSize(size_t size)
 static int
 parseElfHeader(ejElfInfo *info, struct ehdrParams *params)
 {
-    uint16_t phentsize, shentsize;
     const Elf64_Ehdr *ehdr_64 = info->map.data;
     const Elf32_Ehdr *ehdr_32 = info->map.data;
 
     if (info->map.size <= EI_DATA || memcmp(info->map.data, ELFMAG, SELFMAG) != 0) {
-        ejEmitError("Not an ELF file");
+        ejSetError(EJ_ERR_NOT_ELF);
         return EJ_RET_NOT_ELF;
     }
 
     switch (ehdr_64->e_ident[EI_CLASS]) {
     case ELFCLASS32: params->_64 = false; break;
     case ELFCLASS64: params->_64 = true; break;
-    default: ejEmitError("Invalid EI_CLASS in ELF header"); return EJ_RET_MALFORMED_ELF;
+    default: ejSetError(EJ_ERR_BAD_CLASS); return EJ_RET_MALFORMED_ELF;
     }
 
     switch (ehdr_64->e_ident[EI_DATA]) {
@@ -134,15 +132,16 @@ parseElfHeader(ejElfInfo *info, struct ehdrParams *params)
         info->helpers.get_u32 = getBigU32;
         info->helpers.get_u64 = getBigU64;
         break;
-    default: ejEmitError("Invalid EI_DATA in ELF header"); return EJ_RET_MALFORMED_ELF;
+    default: ejSetError(EJ_ERR_BAD_DATA); return EJ_RET_MALFORMED_ELF;
     }
 
     if (info->map.size < (params->_64 ? sizeof(Elf64_Ehdr) : sizeof(Elf32_Ehdr))) {
-        ejEmitError("File is not big enough to contain the ELF header");
+        ejSetSectionError(EJ_ERR_EHDR_TRUNCATED, NULL, 0, 0,
+                          params->_64 ? sizeof(Elf64_Ehdr) : sizeof(Elf32_Ehdr));
         return EJ_RET_MALFORMED_ELF;
     }
 
-    info->visible.machine = ehdr_64->e_machine;
+    info->visible.machine = info->helpers.get_u16(&ehdr_64->e_machine);
 
     if (params->_64) {
         params->phoff = info->helpers.get_u64(&ehdr_64->e_phoff);
@@ -150,8 +149,8 @@ parseElfHeader(ejElfInfo *info, struct ehdrParams *params)
         params->shoff = info->helpers.get_u64(&ehdr_64->e_shoff);
         params->shnum = info->helpers.get_u16(&ehdr_64->e_shnum);
         params->shstrndx = info->helpers.get_u16(&ehdr_64->e_shstrndx);
-        phentsize = info->helpers.get_u16(&ehdr_64->e_phentsize);
-        shentsize = info->helpers.get_u16(&ehdr_64->e_shentsize);
+        params->phentsize = info->helpers.get_u16(&ehdr_64->e_phentsize);
+        params->shentsize = info->helpers.get_u16(&ehdr_64->e_shentsize);
     }
     else {
         params->phoff = info->helpers.get_u32(&ehdr_32->e_phoff);
@@ -159,26 +158,38 @@ parseElfHeader(ejElfInfo *info, struct ehdrParams *params)
         params->shoff = info->helpers.get_u32(&ehdr_32->e_shoff);
         params->shnum = info->helpers.get_u16(&ehdr_32->e_shnum);
         params->shstrndx = info->helpers.get_u16(&ehdr_32->e_shstrndx);
-        phentsize = info->helpers.get_u16(&ehdr_32->e_phentsize);
-        shentsize = info->helpers.get_u16(&ehdr_32->e_shentsize);
-    }
-
-    if (params->shstrndx >= params->shnum) {
-        ejEmitError("Invalid e_shstrndx in ELF header");
-        return EJ_RET_MALFORMED_ELF;
+        params->phentsize = info->helpers.get_u16(&ehdr_32->e_phentsize);
+        params->shentsize = info->helpers.get_u16(&ehdr_32->e_shentsize);
     }
 
     switch (info->helpers.get_u16(&ehdr_64->e_type)) {
     case ET_DYN: info->dynamic = true; break;
     case ET_EXEC: break;
-    default: ejEmitError("File is neither an executable nor a shared object"); return EJ_RET_NOT_ELF;
+    case ET_REL: info->relocatable = true; break;
+    case ET_CORE: info->core = true; break;
+    default: ejSetError(EJ_ERR_BAD_TYPE); return EJ_RET_NOT_ELF;
+    }
+
+    // Objects without program headers (i.e., relocatable objects) typically leave e_phentsize as 0.  Core
+    // files likewise tend to have no section headers.
+    if ((params->phnum != 0 &&
+         params->phentsize < (params->_64 ? sizeof(Elf64_Phdr) : sizeof(Elf32_Phdr))) ||
+        (params->shnum != 0 &&
+         params->shentsize < (params->_64 ? sizeof(Elf64_Shdr) : sizeof(Elf32_Shdr)))) {
+        ejSetError(EJ_ERR_BAD_ENTSIZE);
+        return EJ_RET_MALFORMED_ELF;
+    }
+
+    if (params->shstrndx >= params->shnum && !(info->core && params->shnum == 0)) {
+        ejSetError(EJ_ERR_BAD_SHSTRNDX);
+        return EJ_RET_MALFORMED_ELF;
     }
 
     if (params->shnum >= SHN_LORESERVE) {
         const void *sheader = AT_OFFSET(info->map.data, params->shoff);
 
-        if (params->shoff + shentsize > info->map.size) {
-            ejEmitError("File is not big enough to contain the section header table");
+        if (!RANGE_IN_MAP(&info->map, params->shoff, params->shentsize)) {
+            ejSetSectionError(EJ_ERR_SHDRS_TRUNCATED, NULL, 0, params->shoff, params->shentsize);
             return EJ_RET_MALFORMED_ELF;
         }
 
@@ -194,128 +205,436 @@ parseElfHeader(ejElfInfo *info, struct ehdrParams *params)
         }
     }
 
-    if (params->shnum == 0) {
-        ejEmitError("File contains no section headers");
+    if (params->shnum == 0 && !info->core) {
+        ejSetError(EJ_ERR_NO_SHDRS);
         return EJ_RET_MISSING_INFO;
     }
-    if (params->shoff + shentsize * params->shnum > info->map.size) {
-        ejEmitError("File is not big enough to contain the section header table");
+    // The counts may come from untrusted 64-bit fields.  Divide rather than multiply so that nothing wraps.
+    if (params->shnum > 0 && (params->shoff > info->map.size ||
+                              params->shnum > (info->map.size - params->shoff) / params->shentsize)) {
+        ejSetSectionError(EJ_ERR_SHDRS_TRUNCATED, NULL, 0, params->shoff, params->shentsize * params->shnum);
         return EJ_RET_MALFORMED_ELF;
     }
 
-    if (params->phnum >= PN_XNUM) {
+    if (params->phnum >= PN_XNUM && params->shnum > 0) {
         unsigned int info_offset =
             params->_64 ? offsetof(Elf64_Shdr, sh_info) : offsetof(Elf32_Shdr, sh_info);
 
         params->phnum = info->helpers.get_u32(AT_OFFSET(info->map.data, params->shoff + info_offset));
     }
 
-    if (params->phnum == 0) {
-        ejEmitError("File contains no program headers");
+    if (params->phnum == 0 && !info->relocatable) {
+        ejSetError(EJ_ERR_NO_PHDRS);
         return EJ_RET_MISSING_INFO;
     }
-    if ((unsigned long)(params->phoff + phentsize * params->phnum) > info->map.size) {
-        ejEmitError("File is not big enough to contain the program header table");
+    if (params->phnum > 0 && (params->phoff > info->map.size ||
+                              params->phnum > (info->map.size - params->phoff) / params->phentsize)) {
+        ejSetSectionError(EJ_ERR_PHDRS_TRUNCATED, NULL, 0, params->phoff,
+                          (uint64_t)params->phentsize * params->phnum);
         return EJ_RET_MALFORMED_ELF;
     }
 
     return EJ_RET_OK;
 }
 
-int
-ejParseElf(const char *path, ejElfInfo *info)
+static int
+setSymbolTable(struct ejSymbolInfo *symbols, const char *section_name, uint64_t index, const void *start,
+               const struct ejSection *section, const struct ehdrParams *params)
 {
-    int ret, fd, local_errno;
-    unsigned int load_addr;
-    size_t page_mask;
-    struct stat fs;
-    struct ehdrParams params;
-    int (*find_load_addr)(const struct ejIntHelpers *, const void *, uint32_t, unsigned int *);
-    int (*find_shdrs)(ejElfInfo *, const struct ehdrParams *);
+    symbols->start = start;
+    // Lookups step through the table by the size of the native structure.
+    if (section->entsize != (params->_64 ? sizeof(Elf64_Sym) : sizeof(Elf32_Sym))) {
+        ejSetSectionError(EJ_ERR_SECTION_BAD_ENTSIZE, section_name, index, 0, 0);
+        return EJ_RET_MALFORMED_ELF;
+    }
+    symbols->count = section->size / section->entsize;
+    return EJ_RET_OK;
+}
 
-    if (!path || !info) {
-        ejEmitError("The arguments cannot be NULL");
-        return EJ_RET_BAD_USAGE;
+static int
+setRelocations(struct ejRelInfo *rels, const char *section_name, uint64_t index, const void *start,
+               const struct ejSection *section, const struct ehdrParams *params)
+{
+    rels->start = start;
+    if (section->type == SHT_RELA) {
+        rels->object_size = params->_64 ? sizeof(Elf64_Rela) : sizeof(Elf32_Rela);
+        rels->info_offset = params->_64 ? offsetof(Elf64_Rela, r_info) : offsetof(Elf32_Rela, r_info);
+    }
+    else {
+        rels->object_size = params->_64 ? sizeof(Elf64_Rel) : sizeof(Elf32_Rel);
+        rels->info_offset = params->_64 ? offsetof(Elf64_Rel, r_info) : offsetof(Elf32_Rel, r_info);
     }
+    if (section->entsize != rels->object_size) {
+        ejSetSectionError(EJ_ERR_SECTION_BAD_ENTSIZE, section_name, index, 0, 0);
+        return EJ_RET_MALFORMED_ELF;
+    }
+    rels->count = section->size / rels->object_size;
+    return EJ_RET_OK;
+}
 
-    *info = EJ_ELF_INFO_INIT;
+static int
+classifySections(ejElfInfo *info, const struct ehdrParams *params, struct debugRefs *refs)
+{
+    int ret;
+    const struct ejSection *sections = info->layout.sections;
+    const struct ejSection *shstrtab = &sections[params->shstrndx];
+
+    if (shstrtab->type == SHT_NOBITS) {
+        ejSetSectionError(EJ_ERR_SECTION_MISSING, ".shstrtab", params->shstrndx, 0, 0);
+        return EJ_RET_MALFORMED_ELF;
+    }
+    info->layout.section_names = AT_OFFSET(info->map.data, shstrtab->offset);
+    info->layout.section_names_size = shstrtab->size;
+    if (shstrtab->size == 0) {
+        ejSetSectionError(EJ_ERR_SECTION_EMPTY, ".shstrtab", 0, 0, 0);
+        return EJ_RET_MALFORMED_ELF;
+    }
+    if (info->layout.section_names[shstrtab->size - 1] != '\0') {
+        ejSetSectionError(EJ_ERR_SECTION_UNTERMINATED, ".shstrtab", 0, 0, 0);
+        return EJ_RET_MALFORMED_ELF;
+    }
+
+    for (uint64_t k = 1; k < params->shnum; k++) {
+        const char *section_name;
+        const void *section_start;
+        const struct ejSection *section = &sections[k];
+
+        if (k == params->shstrndx) {
+            continue;
+        }
+
+        if (section->name >= info->layout.section_names_size) {
+            ejSetSectionError(EJ_ERR_SECTION_TRUNCATED, NULL, k, section->offset, section->size);
+            return EJ_RET_MALFORMED_ELF;
+        }
+        section_name = info->layout.section_names + section->name;
+
+        if (info->text_section_index == 0 && strcmp(section_name, ".text") == 0) {
+            info->text_section_index = k;
+            continue;
+        }
+
+        /* Debug companions keep the headers of stripped sections but mark them as SHT_NOBITS. */
+        if (section->type == SHT_NOBITS) {
+            continue;
+        }
+
+        section_start = AT_OFFSET(info->map.data, section->offset);
+        if (!info->symbols.start && strcmp(section_name, ".dynsym") == 0) {
+            ret = setSymbolTable(&info->symbols, ".dynsym", k, section_start, section, params);
+        }
+        else if (!info->symbols.strings && strcmp(section_name, ".dynstr") == 0) {
+            ret = ejSetStringTable(&info->symbols, ".dynstr", section_start, section->size);
+        }
+        else if (!info->full_symbols.start && strcmp(section_name, ".symtab") == 0) {
+            ret = setSymbolTable(&info->full_symbols, ".symtab", k, section_start, section, params);
+        }
+        else if (!info->full_symbols.strings && strcmp(section_name, ".strtab") == 0) {
+            ret = ejSetStringTable(&info->full_symbols, ".strtab", section_start, section->size);
+        }
+        else if (!info->rels.start &&
+                 (strcmp(section_name, ".rela.plt") == 0 || strcmp(section_name, ".rel.plt") == 0)) {
+            // Errors are formatted after the file may have been unmapped so the name can't point into it.
+            section_name = (section->type == SHT_RELA) ? ".rela.plt" : ".rel.plt";
+            ret = setRelocations(&info->rels, section_name, k, section_start, section, params);
+        }
+        else if (!info->dyn_rels.start &&
+                 (strcmp(section_name, ".rela.dyn") == 0 || strcmp(section_name, ".rel.dyn") == 0)) {
+            section_name = (section->type == SHT_RELA) ? ".rela.dyn" : ".rel.dyn";
+            ret = setRelocations(&info->dyn_rels, section_name, k, section_start, section, params);
+        }
+        else if (!refs->build_id && strcmp(section_name, ".note.gnu.build-id") == 0) {
+            ejRecordBuildId(info, refs, section_start, section->size);
+            continue;
+        }
+        else if (!refs->debuglink && strcmp(section_name, ".gnu_debuglink") == 0) {
+            ejRecordDebugLink(info, refs, section_start, section->size);
+            continue;
+        }
+        else if (strcmp(section_name, ".plt") == 0) {
+            info->plt.addr = section->addr;
+            info->plt.size = section->size;
+            continue;
+        }
+        else if (strcmp(section_name, ".got") == 0) {
+            info->got.addr = section->addr;
+            info->got.size = section->size;
+            continue;
+        }
+        else if (strcmp(section_name, ".plt.sec") == 0) {
+            info->plt.sec_addr = section->addr;
+            info->plt.sec_size = section->size;
+            continue;
+        }
+        else {
+            continue;
+        }
+
+        if (ret != EJ_RET_OK) {
+            return ret;
+        }
+    }
+
+    return EJ_RET_OK;
+}
+
+int
+ejMapFile(const char *path, struct ejMapInfo *map)
+{
+    int fd, local_errno;
+    struct stat fs;
+    EJ_TIMER_START(map_timer);
 
     fd = open(path, O_RDONLY);
     if (fd < 0) {
-        ejEmitError("open: %s", strerror(errno));
+        ejSetSystemError(EJ_ERR_OPEN, errno);
         return EJ_RET_READ_FAILURE;
     }
     if (fstat(fd, &fs) != 0) {
-        ejEmitError("fstat: %s", strerror(errno));
+        ejSetSystemError(EJ_ERR_FSTAT, errno);
         close(fd);
         return EJ_RET_READ_FAILURE;
     }
 
-    info->map.size = fs.st_size;
-    info->map.map_size = roundUpToPageSize(fs.st_size);
-    info->map.data = mmap(NULL, info->map.map_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    map->size = fs.st_size;
+    map->map_size = roundUpToPageSize(fs.st_size);
+    map->data = mmap(NULL, map->map_size, PROT_READ, MAP_PRIVATE, fd, 0);
     local_errno = errno;
     close(fd);
-    if (info->map.data == MAP_FAILED) {
-        ejEmitError("mmap: %s", strerror(local_errno));
-        info->map.data = NULL;
+    if (map->data == MAP_FAILED) {
+        ejSetSystemError(EJ_ERR_MMAP, local_errno);
+        map->data = NULL;
         return EJ_RET_MAP_FAIL;
     }
+    EJ_STAT_ADD(bytes_mapped, map->map_size);
+    EJ_TIMER_STOP(map_timer, EJ_PHASE_MAP);
+
+    return EJ_RET_OK;
+}
 
+int
+ejParseImage(ejElfInfo *info, struct debugRefs *refs)
+{
+    int ret;
+    struct ehdrParams params;
+    int (*decode_tables)(ejElfInfo *, const struct ehdrParams *);
+
+    EJ_STAT_INC(parses);
+
+    EJ_TIMER_START(header_timer);
     ret = parseElfHeader(info, &params);
     if (ret != EJ_RET_OK) {
-        goto error;
+        return ret;
     }
 
     if (params._64) {
-        find_load_addr = ejFindLoadAddr64;
-        find_shdrs = ejFindShdrs64;
+        decode_tables = ejDecodeTables64;
         info->find_symbol = ejFindSymbol64;
-        info->find_got_entry = ejFindGotEntry64;
+        info->index_got_slots = ejIndexGotSlots64;
+        info->collect_functions = ejCollectFunctions64;
+        info->collect_globals = ejCollectGlobalFunctions64;
         info->visible.pointer_size = 8;
     }
     else {
-        find_load_addr = ejFindLoadAddr32;
-        find_shdrs = ejFindShdrs32;
+        decode_tables = ejDecodeTables32;
         info->find_symbol = ejFindSymbol32;
-        info->find_got_entry = ejFindGotEntry32;
+        info->index_got_slots = ejIndexGotSlots32;
+        info->collect_functions = ejCollectFunctions32;
+        info->collect_globals = ejCollectGlobalFunctions32;
         info->visible.pointer_size = 4;
     }
 
-    ret = find_load_addr(&info->helpers, AT_OFFSET(info->map.data, params.phoff), params.phnum, &load_addr);
+    if (params.shnum > SIZE_MAX / sizeof(*info->layout.sections) ||
+        (uint64_t)params.phnum * sizeof(*info->layout.segments) > SIZE_MAX) {
+        ejSetError(EJ_ERR_OUT_OF_MEMORY);
+        return EJ_RET_OUT_OF_MEMORY;
+    }
+
+    info->layout.num_sections = params.shnum;
+    info->layout.num_segments = params.phnum;
+    if (params.shnum > 0) {
+        info->layout.sections = malloc(sizeof(*info->layout.sections) * params.shnum);
+    }
+    if (params.phnum > 0) {
+        info->layout.segments = malloc(sizeof(*info->layout.segments) * params.phnum);
+    }
+    if ((params.shnum > 0 && !info->layout.sections) || (params.phnum > 0 && !info->layout.segments)) {
+        ejSetError(EJ_ERR_OUT_OF_MEMORY);
+        return EJ_RET_OUT_OF_MEMORY;
+    }
+
+    ret = decode_tables(info, &params);
     if (ret != EJ_RET_OK) {
-        ejEmitError("No LOAD segment found");
-        goto error;
+        return ret;
     }
 
-    page_mask = ~(pageSize() - 1);
-    info->load_bias = load_addr & page_mask;
+    if (!info->relocatable) {
+        ret = ejBuildLoadMap(info);
+        if (ret != EJ_RET_OK) {
+            return ret;
+        }
+        info->load_bias = info->layout.loads[0].vaddr & ~(pageSize() - 1);
+    }
+    EJ_TIMER_STOP(header_timer, EJ_PHASE_HEADER);
 
-    ret = find_shdrs(info, &params);
+    // Whatever sections a core file has describe the dump rather than the program.
+    if (info->core) {
+        return EJ_RET_OK;
+    }
+
+    EJ_TIMER_START(section_timer);
+    ret = classifySections(info, &params, refs);
+    EJ_TIMER_STOP(section_timer, EJ_PHASE_SECTIONS);
     if (ret != EJ_RET_OK) {
-        goto error;
+        return ret;
     }
 
-    if (!info->symbols.start) {
-        ejEmitError(".dynsym not found");
+    if (info->relocatable) {
+        // Relocatable objects (especially those built with -ffunction-sections) spread their functions
+        // across many sections.
+        info->text_section_index = EJ_ANY_EXEC_SECTION;
+    }
+
+    return EJ_RET_OK;
+}
+
+static int
+parseFile(const char *path, ejElfInfo *info, struct debugRefs *refs)
+{
+    int ret;
+
+    *info = EJ_ELF_INFO_INIT;
+
+    ret = ejMapFile(path, &info->map);
+    if (ret != EJ_RET_OK) {
+        return ret;
+    }
+
+    ret = ejParseImage(info, refs);
+    if (ret != EJ_RET_OK) {
+        ejReleaseInfo(info);
+    }
+    return ret;
+}
+
+static int
+checkRequiredSections(ejElfInfo *info)
+{
+    if (info->core) {
+        ejSetError(EJ_ERR_BAD_TYPE);
+        ejReleaseInfo(info);
+        return EJ_RET_NOT_ELF;
+    }
+
+    if (info->relocatable) {
+        if (!info->full_symbols.start) {
+            ejSetSectionError(EJ_ERR_SECTION_MISSING, ".symtab", 0, 0, 0);
+        }
+        else if (!info->full_symbols.strings) {
+            ejSetSectionError(EJ_ERR_SECTION_MISSING, ".strtab", 0, 0, 0);
+        }
+        else {
+            return EJ_RET_OK;
+        }
+    }
+    else if (!info->symbols.start) {
+        ejSetSectionError(EJ_ERR_SECTION_MISSING, ".dynsym", 0, 0, 0);
     }
     else if (!info->symbols.strings) {
-        ejEmitError(".dynstr not found");
+        ejSetSectionError(EJ_ERR_SECTION_MISSING, ".dynstr", 0, 0, 0);
     }
     else if (info->text_section_index == 0) {
-        ejEmitError(".text not found");
+        ejSetSectionError(EJ_ERR_SECTION_MISSING, ".text", 0, 0, 0);
     }
     else {
         return EJ_RET_OK;
     }
 
-    ret = EJ_RET_MISSING_INFO;
-
-error:
     ejReleaseInfo(info);
+    return EJ_RET_MISSING_INFO;
+}
+
+int
+ejParseElf(const char *path, ejElfInfo *info)
+{
+    return ejParseElfWithFlags(path, info, 0);
+}
+
+int
+ejParseElfWithFlags(const char *path, ejElfInfo *info, unsigned int flags)
+{
+    int ret;
+    struct debugRefs refs = {0};
+
+    if (!path || !info) {
+        ejSetError(EJ_ERR_NULL_ARGUMENT);
+        return EJ_RET_BAD_USAGE;
+    }
+
+    ret = parseFile(path, info, &refs);
+    if (ret != EJ_RET_OK) {
+        return ret;
+    }
+
+    ret = checkRequiredSections(info);
+    if (ret == EJ_RET_OK && (flags & EJ_PARSE_DEBUGINFO)) {
+        ejLoadDebugInfo(info, path, &refs);
+    }
     return ret;
 }
 
+int
+ejParseElfMemory(const void *data, size_t size, ejElfInfo *info)
+{
+    int ret;
+    struct debugRefs refs = {0};
+
+    if (!data || !info) {
+        ejSetError(EJ_ERR_NULL_ARGUMENT);
+        return EJ_RET_BAD_USAGE;
+    }
+
+    *info = EJ_ELF_INFO_INIT;
+    info->map.data = data;
+    info->map.size = size;
+
+    ret = ejParseImage(info, &refs);
+    if (ret != EJ_RET_OK) {
+        ejReleaseInfo(info);
+        return ret;
+    }
+
+    return checkRequiredSections(info);
+}
+
+int
+ejParseCompanion(const char *path, ejElfInfo *info)
+{
+    int ret;
+    struct debugRefs refs = {0};
+
+    ret = parseFile(path, info, &refs);
+    if (ret != EJ_RET_OK) {
+        return ret;
+    }
+
+    if (!info->full_symbols.start) {
+        ejSetSectionError(EJ_ERR_SECTION_MISSING, ".symtab", 0, 0, 0);
+    }
+    else if (!info->full_symbols.strings) {
+        ejSetSectionError(EJ_ERR_SECTION_MISSING, ".strtab", 0, 0, 0);
+    }
+    else if (info->text_section_index == 0) {
+        ejSetSectionError(EJ_ERR_SECTION_MISSING, ".text", 0, 0, 0);
+    }
+    else {
+        return EJ_RET_OK;
+    }
+
+    ejReleaseInfo(info);
+    return EJ_RET_MISSING_INFO;
+}
+
 void
 ejReleaseInfo(ejElfInfo *info)
 {
@@ -323,24 +642,50 @@ ejReleaseInfo(ejElfInfo *info)
         return;
     }
 
-    munmap((void *)info->map.data, info->map.map_size);
+    if (info->debug_info) {
+        ejReleaseInfo(info->debug_info);
+        free(info->debug_info);
+        info->debug_info = NULL;
+    }
+
+    ejFreeFunctionIndex(info->function_index);
+    info->function_index = NULL;
+    ejFreeDemangleIndex(info->demangle_index);
+    info->demangle_index = NULL;
+    ejFreeGotIndex(info->got_index);
+    info->got_index = NULL;
+
+    free(info->layout.sections);
+    free(info->layout.segments);
+    free(info->layout.loads);
+    info->layout.sections = NULL;
+    info->layout.segments = NULL;
+    info->layout.loads = NULL;
+
+    // A map_size of zero means that the memory belongs to the caller (see ejParseElfMemory).
+    if (info->map.data && info->map.map_size != 0) {
+        munmap((void *)info->map.data, info->map.map_size);
+    }
     info->map.data = NULL;
+    info->in_process = false;
 }
 
 ejAddr
 ejFindGotEntry(const ejElfInfo *info, const char *func_name)
 {
+    const struct ejGotSlot *slot;
     ejSymbolValue value;
 
-    if (!INFO_INITIALIZED(info) || !func_name || !info->rels.start) {
+    if (!INFO_INITIALIZED(info) || !func_name || (!info->rels.start && !info->dyn_rels.start)) {
         return EJ_ADDR_NOT_FOUND;
     }
 
-    if (!info->find_symbol(info, func_name, 0, &value)) {
+    if (!info->find_symbol(info, &info->symbols, func_name, 0, &value)) {
         return EJ_ADDR_NOT_FOUND;
     }
 
-    return info->find_got_entry(info, value.index);
+    slot = ejLookupGotSlot(info, value.index);
+    return slot ? slot->addr : EJ_ADDR_NOT_FOUND;
 }
 
 ejAddr
@@ -352,11 +697,30 @@ ejFindFunction(const ejElfInfo *info, const char *func_name)
         return EJ_ADDR_NOT_FOUND;
     }
 
-    if (!info->find_symbol(info, func_name, info->text_section_index, &value)) {
-        return EJ_ADDR_NOT_FOUND;
+    if (info->find_symbol(info, &info->symbols, func_name, info->text_section_index, &value)) {
+        return value.addr;
+    }
+
+    if (info->full_symbols.start &&
+        info->find_symbol(info, &info->full_symbols, func_name, info->text_section_index, &value)) {
+        return value.addr;
+    }
+
+    if (info->debug_info) {
+        const ejElfInfo *debug_info = info->debug_info;
+
+        if (debug_info->find_symbol(debug_info, &debug_info->full_symbols, func_name,
+                                    debug_info->text_section_index, &value)) {
+            return value.addr;
+        }
+    }
+
+    // Only names which look like demangled C++ pay for building the demangled-name index.
+    if (strpbrk(func_name, ":(<")) {
+        return ejFindDemangledFunction(info, func_name);
     }
 
-    return value.addr;
+    return EJ_ADDR_NOT_FOUND;
 }
 
 ejAddr
@@ -366,8 +730,8 @@ ejResolveAddress(const ejElfInfo *info, ejAddr addr, ejAddr file_start)
         return EJ_ADDR_NOT_FOUND;
     }
 
-    if (info->dynamic) {
-        addr += file_start;
+    if (info->dynamic && !info->in_process) {
+        addr = addr - info->load_bias + file_start;
     }
-    return addr - info->load_bias;
+    return addr;
 }
@@ -0,0 +1,89 @@
+#include <stdlib.h>
+
+#include "internal.h"
+
+/*
+ * .rela.plt and .rela.dyn (or their REL counterparts) are each scanned once, with every relocation classified
+ * by the machine's JUMP_SLOT, GLOB_DAT and IRELATIVE types.  A symbol's JUMP_SLOT entry takes precedence over
+ * a GLOB_DAT one since that's where calls through the PLT are resolved.  GLOB_DAT entries cover functions
+ * whose address is taken or which are called without a PLT (e.g., with -fno-plt).  Without a table entry for
+ * the machine, every relocation in .rela.plt is taken to be a JUMP_SLOT as before.
+ */
+static struct ejGotIndex *
+buildGotIndex(const ejElfInfo *info)
+{
+    struct ejGotIndex *index;
+
+    index = malloc(sizeof(*index));
+    if (!index) {
+        return NULL;
+    }
+    index->count = info->symbols.count;
+    index->slots = malloc(sizeof(*index->slots) * (index->count + 1));
+    if (!index->slots) {
+        free(index);
+        return NULL;
+    }
+
+    for (uint64_t k = 0; k < index->count; k++) {
+        index->slots[k] = (struct ejGotSlot){EJ_ADDR_NOT_FOUND, EJ_NO_REL_INDEX, EJ_RELOC_OTHER};
+    }
+
+    if (info->rels.start) {
+        info->index_got_slots(info, &info->rels, index);
+    }
+    if (info->dyn_rels.start) {
+        info->index_got_slots(info, &info->dyn_rels, index);
+    }
+
+    if (info->in_process) {
+        for (uint64_t k = 0; k < index->count; k++) {
+            if (index->slots[k].addr != EJ_ADDR_NOT_FOUND) {
+                index->slots[k].addr += info->base_addr;
+            }
+        }
+    }
+
+    return index;
+}
+
+void
+ejFreeGotIndex(struct ejGotIndex *index)
+{
+    if (index) {
+        free(index->slots);
+        free(index);
+    }
+}
+
+static const struct ejGotIndex *
+getGotIndex(const ejElfInfo *info)
+{
+    struct ejGotIndex *index, *expected = NULL;
+
+    index = EJ_LOAD_INDEX(info->got_index);
+    if (index) {
+        EJ_STAT_INC(cache_hits);
+        return index;
+    }
+    EJ_STAT_INC(cache_misses);
+
+    index = buildGotIndex(info);
+    if (index && !EJ_PUBLISH_INDEX(((ejElfInfo *)info)->got_index, expected, index)) {
+        ejFreeGotIndex(index);
+        index = expected;
+    }
+    return index;
+}
+
+const struct ejGotSlot *
+ejLookupGotSlot(const ejElfInfo *info, uint64_t symbol_index)
+{
+    const struct ejGotIndex *index;
+
+    index = getGotIndex(info);
+    if (!index || symbol_index >= index->count || index->slots[symbol_index].addr == EJ_ADDR_NOT_FOUND) {
+        return NULL;
+    }
+    return &index->slots[symbol_index];
+}
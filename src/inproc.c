@@ -0,0 +1,357 @@
+#define _GNU_SOURCE
+#include <link.h>
+#include <stddef.h>
+
+#include "internal.h"
+#include "parse32.h"
+#include "parse64.h"
+
+#if UINTPTR_MAX == UINT64_MAX
+#define NATIVE_CLASS(name) name##64
+#else
+#define NATIVE_CLASS(name) name##32
+#endif
+
+#define BLOOM_WORD_BITS (sizeof(ElfW(Addr)) * 8)
+
+// ELF32_ST_TYPE and ELF64_ST_TYPE are identical.
+#define SYM_TYPE(sym) ELF64_ST_TYPE((sym)->st_info)
+
+struct moduleSearch {
+    const char *name;
+    ejElfInfo *info;
+    int ret;
+    bool found;
+};
+
+static uint16_t
+getNativeU16(const void *src)
+{
+    uint16_t value;
+
+    memcpy(&value, src, sizeof(value));
+    return value;
+}
+
+static uint32_t
+getNativeU32(const void *src)
+{
+    uint32_t value;
+
+    memcpy(&value, src, sizeof(value));
+    return value;
+}
+
+static uint64_t
+getNativeU64(const void *src)
+{
+    uint64_t value;
+
+    memcpy(&value, src, sizeof(value));
+    return value;
+}
+
+static uint32_t
+gnuHash(const char *name)
+{
+    uint32_t hash = 5381;
+
+    for (const unsigned char *c = (const unsigned char *)name; *c; c++) {
+        hash = hash * 33 + *c;
+    }
+
+    return hash;
+}
+
+static bool
+isDefinedFunction(const ElfW(Sym) * sym)
+{
+    return SYM_TYPE(sym) == STT_FUNC && sym->st_shndx != SHN_UNDEF;
+}
+
+static bool
+findViaGnuHash(const ejElfInfo *info, const char *func_name, ejSymbolValue *value)
+{
+    uint32_t nbuckets, symoffset, bloom_size, bloom_shift, hash, index;
+    ElfW(Addr) word, mask;
+    const ElfW(Addr) * bloom;
+    const uint32_t *buckets, *chain;
+    const ElfW(Sym) *syms = info->symbols.start;
+
+    nbuckets = info->gnu_hash[0];
+    symoffset = info->gnu_hash[1];
+    bloom_size = info->gnu_hash[2];
+    bloom_shift = info->gnu_hash[3];
+    if (nbuckets == 0 || bloom_size == 0) {
+        return false;
+    }
+    bloom = (const void *)&info->gnu_hash[4];
+    buckets = (const void *)&bloom[bloom_size];
+    chain = &buckets[nbuckets];
+
+    hash = gnuHash(func_name);
+    word = bloom[(hash / BLOOM_WORD_BITS) % bloom_size];
+    mask = ((ElfW(Addr))1 << (hash % BLOOM_WORD_BITS)) |
+           ((ElfW(Addr))1 << ((hash >> bloom_shift) % BLOOM_WORD_BITS));
+    if ((word & mask) != mask) {
+        return false;
+    }
+
+    index = buckets[hash % nbuckets];
+    if (index < symoffset) {
+        return false;
+    }
+
+    for (;; index++) {
+        uint32_t chain_hash = chain[index - symoffset];
+        const ElfW(Sym) *sym = &syms[index];
+
+        EJ_STAT_INC(symbols_compared);
+        if ((chain_hash | 1) == (hash | 1) && isDefinedFunction(sym) &&
+            sym->st_name < info->symbols.strings_size) {
+            EJ_STAT_INC(string_compares);
+            if (strcmp(info->symbols.strings + sym->st_name, func_name) == 0) {
+                value->addr = info->base_addr + sym->st_value;
+                return true;
+            }
+        }
+
+        if (chain_hash & 1) {
+            return false;
+        }
+    }
+}
+
+/*
+ * In-process modules have no section headers, so any nonzero section_index selects defined functions.
+ */
+static bool
+findSymbolInProcess(const ejElfInfo *info, const struct ejSymbolInfo *symbols, const char *func_name,
+                    uint32_t section_index, ejSymbolValue *value)
+{
+    bool found = false;
+    const ElfW(Sym) *syms = symbols->start;
+    EJ_TIMER_START(timer);
+
+    if (section_index == 0) {
+        found = NATIVE_CLASS(ejFindSymbol)(info, symbols, func_name, 0, value);
+    }
+    else if (info->gnu_hash) {
+        found = findViaGnuHash(info, func_name, value);
+    }
+    else {
+        for (uint64_t k = 0; k < symbols->count; k++) {
+            EJ_STAT_INC(symbols_compared);
+            if (!isDefinedFunction(&syms[k]) || syms[k].st_name >= symbols->strings_size) {
+                continue;
+            }
+
+            EJ_STAT_INC(string_compares);
+            if (strcmp(symbols->strings + syms[k].st_name, func_name) == 0) {
+                value->addr = info->base_addr + syms[k].st_value;
+                found = true;
+                break;
+            }
+        }
+    }
+
+    EJ_TIMER_STOP(timer, EJ_PHASE_SYMBOLS);
+    return found;
+}
+
+static uint64_t
+gnuHashSymbolCount(const uint32_t *gnu_hash)
+{
+    uint32_t nbuckets, symoffset, bloom_size, last = 0;
+    const uint32_t *buckets, *chain;
+
+    nbuckets = gnu_hash[0];
+    symoffset = gnu_hash[1];
+    bloom_size = gnu_hash[2];
+    buckets = (const void *)((const ElfW(Addr) *)&gnu_hash[4] + bloom_size);
+    chain = &buckets[nbuckets];
+
+    for (uint32_t k = 0; k < nbuckets; k++) {
+        if (buckets[k] > last) {
+            last = buckets[k];
+        }
+    }
+    if (last < symoffset) {
+        return symoffset;
+    }
+
+    while (!(chain[last - symoffset] & 1)) {
+        last++;
+    }
+    return (uint64_t)last + 1;
+}
+
+static const void *
+dynamicPointer(const struct dl_phdr_info *module, ElfW(Addr) ptr)
+{
+    /* glibc relocates most d_ptr entries in place but some architectures (and other loaders) do not. */
+    if (ptr < module->dlpi_addr) {
+        ptr += module->dlpi_addr;
+    }
+    return (const void *)ptr;
+}
+
+static int
+parseModule(const struct dl_phdr_info *module, ejElfInfo *info)
+{
+    uint64_t syment = 0, pltrelsz = 0, pltrel = 0, relasz = 0, relsz = 0;
+    const void *rela = NULL, *rel = NULL;
+    const ElfW(Dyn) *dyn = NULL;
+    const uint32_t *sysv_hash = NULL;
+
+    *info = EJ_ELF_INFO_INIT;
+    info->in_process = true;
+    info->base_addr = module->dlpi_addr;
+    info->text_section_index = 1;
+    info->find_symbol = findSymbolInProcess;
+    info->index_got_slots = NATIVE_CLASS(ejIndexGotSlots);
+    info->collect_functions = NATIVE_CLASS(ejCollectFunctions);
+    info->collect_globals = NATIVE_CLASS(ejCollectGlobalFunctions);
+    info->helpers.get_u16 = getNativeU16;
+    info->helpers.get_u32 = getNativeU32;
+    info->helpers.get_u64 = getNativeU64;
+    info->visible.pointer_size = sizeof(void *);
+    info->visible.little_endian = (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__);
+
+    for (ElfW(Half) k = 0; k < module->dlpi_phnum; k++) {
+        const ElfW(Phdr) *phdr = &module->dlpi_phdr[k];
+
+        if (phdr->p_type == PT_DYNAMIC) {
+            dyn = (const void *)(module->dlpi_addr + phdr->p_vaddr);
+        }
+        else if (phdr->p_type == PT_LOAD && phdr->p_offset == 0) {
+            const ElfW(Ehdr) *ehdr = (const void *)(module->dlpi_addr + phdr->p_vaddr);
+
+            info->visible.machine = ehdr->e_machine;
+        }
+    }
+
+    if (!dyn) {
+        ejSetSectionError(EJ_ERR_SECTION_MISSING, "PT_DYNAMIC", 0, 0, 0);
+        return EJ_RET_MISSING_INFO;
+    }
+
+    for (; dyn->d_tag != DT_NULL; dyn++) {
+        switch (dyn->d_tag) {
+        case DT_SYMTAB: info->symbols.start = dynamicPointer(module, dyn->d_un.d_ptr); break;
+        case DT_STRTAB: info->symbols.strings = dynamicPointer(module, dyn->d_un.d_ptr); break;
+        case DT_STRSZ: info->symbols.strings_size = dyn->d_un.d_val; break;
+        case DT_SYMENT: syment = dyn->d_un.d_val; break;
+        case DT_GNU_HASH: info->gnu_hash = dynamicPointer(module, dyn->d_un.d_ptr); break;
+        case DT_HASH: sysv_hash = dynamicPointer(module, dyn->d_un.d_ptr); break;
+        case DT_JMPREL: info->rels.start = dynamicPointer(module, dyn->d_un.d_ptr); break;
+        case DT_PLTRELSZ: pltrelsz = dyn->d_un.d_val; break;
+        case DT_PLTREL: pltrel = dyn->d_un.d_val; break;
+        case DT_RELA: rela = dynamicPointer(module, dyn->d_un.d_ptr); break;
+        case DT_RELASZ: relasz = dyn->d_un.d_val; break;
+        case DT_REL: rel = dynamicPointer(module, dyn->d_un.d_ptr); break;
+        case DT_RELSZ: relsz = dyn->d_un.d_val; break;
+        default: break;
+        }
+    }
+
+    if (!info->symbols.start) {
+        ejSetSectionError(EJ_ERR_SECTION_MISSING, "DT_SYMTAB", 0, 0, 0);
+        return EJ_RET_MISSING_INFO;
+    }
+    if (!info->symbols.strings || info->symbols.strings_size == 0) {
+        ejSetSectionError(EJ_ERR_SECTION_MISSING, "DT_STRTAB", 0, 0, 0);
+        return EJ_RET_MISSING_INFO;
+    }
+    if (syment != 0 && syment != sizeof(ElfW(Sym))) {
+        ejSetSectionError(EJ_ERR_SECTION_BAD_ENTSIZE, "DT_SYMTAB", 0, 0, 0);
+        return EJ_RET_MALFORMED_ELF;
+    }
+
+    if (sysv_hash) {
+        info->symbols.count = sysv_hash[1];
+    }
+    else if (info->gnu_hash) {
+        info->symbols.count = gnuHashSymbolCount(info->gnu_hash);
+    }
+    else {
+        ejSetSectionError(EJ_ERR_SECTION_MISSING, "DT_GNU_HASH", 0, 0, 0);
+        return EJ_RET_MISSING_INFO;
+    }
+
+    if (info->rels.start) {
+        if (pltrel == DT_RELA) {
+            info->rels.object_size = sizeof(ElfW(Rela));
+            info->rels.info_offset = offsetof(ElfW(Rela), r_info);
+        }
+        else {
+            info->rels.object_size = sizeof(ElfW(Rel));
+            info->rels.info_offset = offsetof(ElfW(Rel), r_info);
+        }
+        info->rels.count = pltrelsz / info->rels.object_size;
+    }
+
+    if (rela) {
+        info->dyn_rels.start = rela;
+        info->dyn_rels.object_size = sizeof(ElfW(Rela));
+        info->dyn_rels.info_offset = offsetof(ElfW(Rela), r_info);
+        info->dyn_rels.count = relasz / info->dyn_rels.object_size;
+    }
+    else if (rel) {
+        info->dyn_rels.start = rel;
+        info->dyn_rels.object_size = sizeof(ElfW(Rel));
+        info->dyn_rels.info_offset = offsetof(ElfW(Rel), r_info);
+        info->dyn_rels.count = relsz / info->dyn_rels.object_size;
+    }
+
+    return EJ_RET_OK;
+}
+
+static int
+moduleCallback(struct dl_phdr_info *module, size_t size, void *data)
+{
+    const char *module_name, *slash;
+    struct moduleSearch *search = data;
+    (void)size;
+
+    module_name = module->dlpi_name ? module->dlpi_name : "";
+    if (!search->name) {
+        if (module_name[0] != '\0') {
+            return 0;
+        }
+    }
+    else if (strcmp(module_name, search->name) != 0) {
+        slash = strrchr(module_name, '/');
+        if (!slash || strcmp(slash + 1, search->name) != 0) {
+            return 0;
+        }
+    }
+
+    search->found = true;
+    search->ret = parseModule(module, search->info);
+    return 1;
+}
+
+int
+ejParseLoadedModule(const char *name, ejElfInfo *info)
+{
+    struct moduleSearch search = {.info = info};
+
+    if (!info) {
+        ejSetError(EJ_ERR_NULL_ARGUMENT);
+        return EJ_RET_BAD_USAGE;
+    }
+
+    search.name = (name && name[0] != '\0') ? name : NULL;
+    dl_iterate_phdr(moduleCallback, &search);
+    if (!search.found) {
+        *info = EJ_ELF_INFO_INIT;
+        ejSetError(EJ_ERR_MODULE_NOT_FOUND);
+        return EJ_RET_MISSING_INFO;
+    }
+
+    if (search.ret != EJ_RET_OK) {
+        *info = EJ_ELF_INFO_INIT;
+    }
+    return search.ret;
+}
@@ -1,24 +1,151 @@
-#include <stdarg.h>
 #include <stdio.h>
 
 #include <elfjack/config.h>
 
 #include "internal.h"
 
+static _Thread_local struct ejErrorInfo error_info;
 static _Thread_local char error_buffer[EJ_ERROR_BUFFER_SIZE];
+static _Thread_local bool error_formatted;
+
+static const char *const error_messages[] = {
+    [EJ_ERR_NONE] = "No error",
+    [EJ_ERR_NULL_ARGUMENT] = "The arguments cannot be NULL",
+    [EJ_ERR_OPEN] = "open",
+    [EJ_ERR_FSTAT] = "fstat",
+    [EJ_ERR_MMAP] = "mmap",
+    [EJ_ERR_NOT_ELF] = "Not an ELF file",
+    [EJ_ERR_BAD_CLASS] = "Invalid EI_CLASS in ELF header",
+    [EJ_ERR_BAD_DATA] = "Invalid EI_DATA in ELF header",
+    [EJ_ERR_BAD_TYPE] = "File is not an executable, shared object, or relocatable object",
+    [EJ_ERR_BAD_SHSTRNDX] = "Invalid e_shstrndx in ELF header",
+    [EJ_ERR_EHDR_TRUNCATED] = "File is not big enough to contain the ELF header",
+    [EJ_ERR_SHDRS_TRUNCATED] = "File is not big enough to contain the section header table",
+    [EJ_ERR_PHDRS_TRUNCATED] = "File is not big enough to contain the program header table",
+    [EJ_ERR_NO_SHDRS] = "File contains no section headers",
+    [EJ_ERR_NO_PHDRS] = "File contains no program headers",
+    [EJ_ERR_NO_LOAD] = "No LOAD segment found",
+    [EJ_ERR_SECTION_TRUNCATED] = "File is not big enough to contain %s",
+    [EJ_ERR_SECTION_EMPTY] = "%s is empty",
+    [EJ_ERR_SECTION_UNTERMINATED] = "%s is not null-terminated",
+    [EJ_ERR_SECTION_BAD_ENTSIZE] = "%s section has invalid sh_entsize",
+    [EJ_ERR_SECTION_MISSING] = "%s not found",
+    [EJ_ERR_BAD_ENTSIZE] = "Invalid e_phentsize or e_shentsize in ELF header",
+    [EJ_ERR_OUT_OF_MEMORY] = "Failed to allocate memory",
+    [EJ_ERR_MODULE_NOT_FOUND] = "No such module is loaded",
+    [EJ_ERR_GOT_ENTRY_NOT_FOUND] = "GOT entry not found",
+    [EJ_ERR_BAD_POINTER_SIZE] = "Pointer size or byte order does not match the target process",
+    [EJ_ERR_PROCESS_VM_READV] = "process_vm_readv",
+    [EJ_ERR_PROCESS_VM_WRITEV] = "process_vm_writev",
+    [EJ_ERR_PARTIAL_TRANSFER] = "Only part of the GOT entries could be transferred",
+    [EJ_ERR_NOT_ARCHIVE] = "Not an ar archive",
+    [EJ_ERR_ARCHIVE_MALFORMED] = "Malformed archive member header",
+    [EJ_ERR_NOT_CORE] = "File is not a core dump",
+    [EJ_ERR_NOTE_MALFORMED] = "Malformed %s note",
+    [EJ_ERR_UNSUPPORTED_MACHINE] = "Unsupported e_machine",
+    [EJ_ERR_FUNCTION_NOT_FOUND] = "Function not found",
+    [EJ_ERR_FUNCTION_NOT_MAPPED] = "Function is not contained in the file",
+};
+
+static void
+formatError(void)
+{
+    int len;
+    const char *message = "Unknown error";
+    char label[32];
+
+    if ((size_t)error_info.code < sizeof(error_messages) / sizeof(error_messages[0])) {
+        message = error_messages[error_info.code];
+    }
+
+#ifdef __GNUC__
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-nonliteral"
+#endif
+    if (error_info.section_name) {
+        len = snprintf(error_buffer, sizeof(error_buffer), message, error_info.section_name);
+    }
+    else {
+        snprintf(label, sizeof(label), "section #%llu", (unsigned long long)error_info.section_index);
+        len = snprintf(error_buffer, sizeof(error_buffer), message, label);
+    }
+#ifdef __GNUC__
+#pragma GCC diagnostic pop
+#endif
+
+    if (len >= 0 && (size_t)len < sizeof(error_buffer)) {
+        if (error_info.errnum != 0) {
+            snprintf(error_buffer + len, sizeof(error_buffer) - len, ": %s", strerror(error_info.errnum));
+        }
+        else if (error_info.section_name && error_info.section_index != 0) {
+            snprintf(error_buffer + len, sizeof(error_buffer) - len, " (section #%llu)",
+                     (unsigned long long)error_info.section_index);
+        }
+        else if (error_info.expected_size != 0) {
+            snprintf(error_buffer + len, sizeof(error_buffer) - len, " (offset 0x%llx, expected size %llu)",
+                     (unsigned long long)error_info.offset, (unsigned long long)error_info.expected_size);
+        }
+    }
+
+    error_formatted = true;
+}
 
 char *
 ejGetError(void)
 {
+    if (!error_formatted) {
+        formatError();
+    }
     return error_buffer;
 }
 
+const struct ejErrorInfo *
+ejGetErrorInfo(void)
+{
+    return &error_info;
+}
+
 void
-ejEmitError(const char *format, ...)
+ejSetError(enum ejErrorCode code)
+{
+    error_info = (struct ejErrorInfo){.code = code};
+    error_formatted = false;
+}
+
+void
+ejSetSystemError(enum ejErrorCode code, int errnum)
+{
+    error_info = (struct ejErrorInfo){.code = code, .errnum = errnum};
+    error_formatted = false;
+}
+
+void
+ejSetSectionError(enum ejErrorCode code, const char *section_name, uint64_t section_index, uint64_t offset,
+                  uint64_t expected_size)
+{
+    error_info = (struct ejErrorInfo){
+        .code = code,
+        .section_name = section_name,
+        .section_index = section_index,
+        .offset = offset,
+        .expected_size = expected_size,
+    };
+    error_formatted = false;
+}
+
+int
+ejSetStringTable(struct ejSymbolInfo *symbols, const char *section_name, const void *start, uint64_t size)
 {
-    va_list args;
+    symbols->strings = start;
+    symbols->strings_size = size;
+    if (size == 0) {
+        ejSetSectionError(EJ_ERR_SECTION_EMPTY, section_name, 0, 0, 0);
+        return EJ_RET_MALFORMED_ELF;
+    }
+    if (symbols->strings[size - 1] != '\0') {
+        ejSetSectionError(EJ_ERR_SECTION_UNTERMINATED, section_name, 0, 0, 0);
+        return EJ_RET_MALFORMED_ELF;
+    }
 
-    va_start(args, format);
-    vsnprintf(error_buffer, sizeof(error_buffer), format, args);
-    va_end(args);
+    return EJ_RET_OK;
 }
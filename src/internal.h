@@ -8,6 +8,44 @@
 #include <elfjack/elfjack.h>
 
 #define AT_OFFSET(ptr, offset) ((void *)((unsigned char *)(ptr) + (offset)))
+#define INFO_INITIALIZED(info) ((info) && ((info)->map.data || (info)->in_process))
+#define RANGE_IN_MAP(map, offset, length) \
+    ((offset) <= (map)->size && (length) <= (map)->size - (offset))
+
+// Passed as the section index to select functions from every executable section of a relocatable object.  It
+// lies outside the range of st_shndx so that no symbol can match it directly.
+#define EJ_ANY_EXEC_SECTION UINT32_MAX
+// Reserved indices (e.g., SHN_ABS or SHN_XINDEX) don't name a section.
+#define SECTION_IS_EXEC(info, index)                                     \
+    ((index) < SHN_LORESERVE && (index) < (info)->layout.num_sections && \
+     ((info)->layout.sections[index].flags & SHF_EXECINSTR))
+// Symbol values in a relocatable object are relative to their section.  Report file offsets instead.
+#define SYMBOL_BASE(info, index) ((info)->relocatable ? (info)->layout.sections[index].offset : 0)
+
+#ifdef EJ_STATS
+extern _Thread_local struct ejStats ejThreadStats;
+
+#define EJ_STAT_ADD(field, amount) (ejThreadStats.field += (amount))
+#define EJ_TIMER_START(timer)      uint64_t timer = ejNanoseconds()
+#define EJ_TIMER_STOP(timer, phase) (ejThreadStats.phase_ns[phase] += ejNanoseconds() - (timer))
+
+uint64_t
+ejNanoseconds(void);
+#else
+#define EJ_STAT_ADD(field, amount) ((void)0)
+#define EJ_TIMER_START(timer)
+#define EJ_TIMER_STOP(timer, phase) ((void)0)
+#endif
+
+#define EJ_STAT_INC(field) EJ_STAT_ADD(field, 1)
+
+/*
+ * Indexes built lazily by queries are published with a compare-and-swap so that any number of threads can
+ * share an info object without locking.  A thread which loses the race frees its copy and uses the winner's.
+ */
+#define EJ_LOAD_INDEX(slot) __atomic_load_n(&(slot), __ATOMIC_ACQUIRE)
+#define EJ_PUBLISH_INDEX(slot, expected, index) \
+    __atomic_compare_exchange_n(&(slot), &(expected), (index), false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
 
 struct ehdrParams {
     uint64_t shoff;
@@ -15,12 +53,129 @@ struct ehdrParams {
     uint16_t shstrndx;
     uint64_t phoff;
     uint32_t phnum;
+    uint16_t shentsize;
+    uint16_t phentsize;
     unsigned int _64 : 1;
 };
 
+struct debugRefs {
+    const unsigned char *build_id;
+    size_t build_id_size;
+    const char *debuglink;
+    uint32_t debuglink_crc;
+};
+
 void
-ejEmitError(const char *format, ...)
-#ifdef __GNUC__
-    __attribute__((format(printf, 1, 2)))
-#endif
-    ;
+ejSetError(enum ejErrorCode code);
+
+void
+ejSetSystemError(enum ejErrorCode code, int errnum);
+
+void
+ejSetSectionError(enum ejErrorCode code, const char *section_name, uint64_t section_index, uint64_t offset,
+                  uint64_t expected_size);
+
+struct ejArch {
+    uint16_t machine;
+    // Index of the program counter within the general-purpose registers of NT_PRSTATUS.
+    unsigned int pc_register;
+    // Layout of lazy-binding PLT stubs (an entry size of 0 means that they can't be located this way).
+    unsigned int plt_header_size;
+    unsigned int plt_entry_size;
+    unsigned int plt_sec_entry_size;
+};
+
+// Relocation types which fill GOT entries.
+struct ejRelocTypes {
+    uint16_t machine;
+    // 0 if the types are the same for both ELF classes.
+    unsigned char pointer_size;
+    uint32_t jump_slot;
+    uint32_t glob_dat;
+    uint32_t irelative;
+    // Whether glob_dat is a plain word relocation which is also used for data outside of the GOT.
+    bool generic_glob_dat;
+};
+
+enum ejRelocationKind {
+    EJ_RELOC_OTHER = 0,
+    EJ_RELOC_JUMP_SLOT,
+    EJ_RELOC_GLOB_DAT,
+    EJ_RELOC_IRELATIVE,
+};
+
+// The GOT entry of a symbol.  rel_index is its position in .rela.plt (or .rel.plt) if it has a PLT entry.
+struct ejGotSlot {
+    ejAddr addr;
+    uint64_t rel_index;
+    enum ejRelocationKind kind;
+};
+
+#define EJ_NO_REL_INDEX UINT64_MAX
+
+// Indexed by the symbol's index in the dynamic symbol table.
+struct ejGotIndex {
+    struct ejGotSlot *slots;
+    uint64_t count;
+};
+
+// A global (defined or imported) function symbol.
+struct ejGlobalFunction {
+    const char *name;
+    ejAddr value;
+    uint64_t size;
+    uint64_t index;
+};
+
+struct ejFunctionIndex {
+    struct ejFunction *functions;
+    size_t count;
+};
+
+int
+ejMapFile(const char *path, struct ejMapInfo *map);
+
+int
+ejParseImage(ejElfInfo *info, struct debugRefs *refs);
+
+int
+ejBuildLoadMap(ejElfInfo *info);
+
+void
+ejFreeFunctionIndex(struct ejFunctionIndex *index);
+
+void
+ejFreeDemangleIndex(struct ejDemangleIndex *index);
+
+const struct ejFunction *
+ejLookupFunction(const ejElfInfo *info, ejAddr addr);
+
+void
+ejFreeGotIndex(struct ejGotIndex *index);
+
+const struct ejGotSlot *
+ejLookupGotSlot(const ejElfInfo *info, uint64_t symbol_index);
+
+int
+ejSetStringTable(struct ejSymbolInfo *symbols, const char *section_name, const void *start, uint64_t size);
+
+void
+ejRecordBuildId(const ejElfInfo *info, struct debugRefs *refs, const void *start, uint64_t size);
+
+void
+ejRecordDebugLink(const ejElfInfo *info, struct debugRefs *refs, const void *start, uint64_t size);
+
+void
+ejLoadDebugInfo(ejElfInfo *info, const char *path, const struct debugRefs *refs);
+
+int
+ejParseCompanion(const char *path, ejElfInfo *info);
+
+const struct ejArch *
+ejLookupArch(uint16_t machine);
+
+const struct ejRelocTypes *
+ejLookupRelocTypes(uint16_t machine, unsigned int pointer_size);
+
+enum ejRelocationKind
+ejClassifyRelocation(const ejElfInfo *info, const struct ejRelocTypes *types, uint32_t type, ejAddr offset);
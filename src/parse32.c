@@ -3,181 +3,192 @@
 
 #include "parse32.h"
 
-static bool
-shdrSanityCheck(const ejElfInfo *info, const Elf32_Shdr *shdr)
-{
-    return info->helpers.get_u32(&shdr->sh_offset) + info->helpers.get_u32(&shdr->sh_size) <= info->map.size;
-}
-
-static const char *
-getShdrStrings(const ejElfInfo *info, const Elf32_Shdr *shdr, size_t *size)
-{
-    const char *strings;
-
-    if (!shdrSanityCheck(info, shdr)) {
-        ejEmitError("File is not big enough to contain the section header string table");
-        return NULL;
-    }
-
-    strings = AT_OFFSET(info->map.data, info->helpers.get_u32(&shdr->sh_offset));
-    *size = shdr->sh_size;
-    if (*size == 0) {
-        ejEmitError("Section header string table is empty");
-        return NULL;
-    }
-    if (strings[*size - 1] != '\0') {
-        ejEmitError("Section header string table is not null-terminated");
-        return NULL;
-    }
-
-    return strings;
-}
-
 int
-ejFindLoadAddr32(const struct ejIntHelpers *helpers, const void *pheader, uint32_t phnum,
-                 unsigned int *load_addr)
+ejDecodeTables32(ejElfInfo *info, const struct ehdrParams *params)
 {
-    const Elf32_Phdr *phdr = pheader;
+    const unsigned char *pheader = AT_OFFSET(info->map.data, params->phoff);
+    const unsigned char *sheader = AT_OFFSET(info->map.data, params->shoff);
+
+    for (uint32_t k = 0; k < params->phnum; k++) {
+        const Elf32_Phdr *phdr = (const void *)(pheader + (size_t)k * params->phentsize);
+        struct ejSegment *segment = &info->layout.segments[k];
+
+        segment->type = info->helpers.get_u32(&phdr->p_type);
+        segment->flags = info->helpers.get_u32(&phdr->p_flags);
+        segment->offset = info->helpers.get_u32(&phdr->p_offset);
+        segment->vaddr = info->helpers.get_u32(&phdr->p_vaddr);
+        segment->filesz = info->helpers.get_u32(&phdr->p_filesz);
+        segment->memsz = info->helpers.get_u32(&phdr->p_memsz);
+    }
 
-    for (uint32_t k = 0; k < phnum; k++) {
-        if (helpers->get_u32(&phdr[k].p_type) == PT_LOAD) {
-            *load_addr = helpers->get_u32(&phdr[k].p_offset);
-            return EJ_RET_OK;
+    for (uint64_t k = 0; k < params->shnum; k++) {
+        const Elf32_Shdr *shdr = (const void *)(sheader + k * params->shentsize);
+        struct ejSection *section = &info->layout.sections[k];
+
+        EJ_STAT_INC(sections_scanned);
+        section->name = info->helpers.get_u32(&shdr->sh_name);
+        section->type = info->helpers.get_u32(&shdr->sh_type);
+        section->flags = info->helpers.get_u32(&shdr->sh_flags);
+        section->addr = info->helpers.get_u32(&shdr->sh_addr);
+        section->offset = info->helpers.get_u32(&shdr->sh_offset);
+        section->size = info->helpers.get_u32(&shdr->sh_size);
+        section->link = info->helpers.get_u32(&shdr->sh_link);
+        section->info = info->helpers.get_u32(&shdr->sh_info);
+        section->entsize = info->helpers.get_u32(&shdr->sh_entsize);
+
+        // The first entry's fields hold the extended counts rather than a range.
+        if (k > 0 && section->type != SHT_NOBITS && !RANGE_IN_MAP(&info->map, section->offset, section->size)) {
+            ejSetSectionError(EJ_ERR_SECTION_TRUNCATED, NULL, k, section->offset, section->size);
+            return EJ_RET_MALFORMED_ELF;
         }
     }
 
-    return EJ_RET_MISSING_INFO;
+    return EJ_RET_OK;
 }
 
-int
-ejFindShdrs32(ejElfInfo *info, const struct ehdrParams *params)
+bool
+ejFindSymbol32(const ejElfInfo *info, const struct ejSymbolInfo *symbols, const char *func_name,
+               uint32_t section_index, ejSymbolValue *value)
 {
-    unsigned int num_found = 0;
-    size_t strings_size;
-    const char *strings;
-    const Elf32_Shdr *table = AT_OFFSET(info->map.data, params->shoff);
-
-    strings = getShdrStrings(info, &table[params->shstrndx], &strings_size);
-    if (!strings) {
-        return EJ_RET_MALFORMED_ELF;
-    }
+    bool found = false;
+    const Elf32_Sym *syms = symbols->start;
+    EJ_TIMER_START(timer);
 
-    for (uint64_t k = 1; k < params->shnum; k++) {
-        uint32_t name, size, entsize;
-        const char *section_name;
-        const void *section_start;
-        const Elf32_Shdr *shdr = &table[k];
+    for (uint64_t k = 0; k < symbols->count; k++) {
+        uint16_t shndx;
+        uint32_t name;
+        const Elf32_Sym *sym = &syms[k];
 
-        if (k == params->shstrndx) {
+        EJ_STAT_INC(symbols_compared);
+        if (ELF32_ST_TYPE(sym->st_info) != STT_FUNC) {
             continue;
         }
-
-        if (!shdrSanityCheck(info, shdr) || (name = info->helpers.get_u32(&shdr->sh_name)) >= strings_size) {
-            ejEmitError("File is not big enough to contain section #%llu", (unsigned long long)k);
-            return EJ_RET_MALFORMED_ELF;
-        }
-        section_start = AT_OFFSET(info->map.data, shdr->sh_offset);
-        section_name = strings + shdr->sh_name;
-
-        size = info->helpers.get_u32(&shdr->sh_size);
-        entsize = info->helpers.get_u32(&shdr->sh_entsize);
-        if (!info->symbols.start && strcmp(section_name, ".dynsym") == 0) {
-            if (entsize == 0) {
-                ejEmitError(".dynsym section has invalid sh_entsize");
-                return EJ_RET_MALFORMED_ELF;
-            }
-            info->symbols.start = section_start;
-            info->symbols.count = size / entsize;
+        shndx = info->helpers.get_u16(&sym->st_shndx);
+        if (shndx != section_index &&
+            !(section_index == EJ_ANY_EXEC_SECTION && SECTION_IS_EXEC(info, shndx))) {
+            continue;
         }
-        else if (!info->symbols.strings && strcmp(section_name, ".dynstr") == 0) {
-            info->symbols.strings = section_start;
-            info->symbols.strings_size = size;
-            if (info->symbols.strings_size == 0) {
-                ejEmitError(".dynstr is empty");
-                return EJ_RET_MALFORMED_ELF;
-            }
-            if (info->symbols.strings[info->symbols.strings_size - 1] != '\0') {
-                ejEmitError(".dynstr is not null-terminated");
-                return EJ_RET_MALFORMED_ELF;
-            }
+
+        name = info->helpers.get_u32(&sym->st_name);
+        if (name >= symbols->strings_size) {
+            break;
         }
-        else if (!info->rels.start &&
-                 (strcmp(section_name, ".rela.plt") == 0 || strcmp(section_name, ".rel.plt") == 0)) {
-            if (entsize == 0) {
-                ejEmitError(".rela.plt section has invalid sh_entsize");
-                return EJ_RET_MALFORMED_ELF;
-            }
-            info->rels.start = section_start;
-            info->rels.count = size / entsize;
-            if (shdr->sh_type == SHT_RELA) {
-                info->rels.object_size = sizeof(Elf32_Rela);
-                info->rels.info_offset = offsetof(Elf32_Rela, r_info);
+        EJ_STAT_INC(string_compares);
+        if (strcmp(symbols->strings + name, func_name) == 0) {
+            if (section_index == 0) {
+                value->index = k;
             }
             else {
-                info->rels.object_size = sizeof(Elf32_Rel);
-                info->rels.info_offset = offsetof(Elf32_Rel, r_info);
+                value->addr = info->helpers.get_u32(&sym->st_value) + SYMBOL_BASE(info, shndx);
             }
+            found = true;
+            break;
         }
-        else if (info->text_section_index == 0 && strcmp(section_name, ".text") == 0) {
-            info->text_section_index = k;
-        }
-        else {
+    }
+
+    EJ_TIMER_STOP(timer, EJ_PHASE_SYMBOLS);
+    return found;
+}
+
+uint64_t
+ejCollectFunctions32(const ejElfInfo *info, const struct ejSymbolInfo *symbols, struct ejFunction *functions)
+{
+    uint64_t count = 0;
+    const Elf32_Sym *syms = symbols->start;
+
+    for (uint64_t k = 0; k < symbols->count; k++) {
+        uint16_t shndx;
+        uint32_t name;
+        const Elf32_Sym *sym = &syms[k];
+
+        shndx = info->helpers.get_u16(&sym->st_shndx);
+        if (ELF32_ST_TYPE(sym->st_info) != STT_FUNC || shndx == SHN_UNDEF ||
+            (info->relocatable && !SECTION_IS_EXEC(info, shndx))) {
             continue;
         }
 
-        if (++num_found == 4) {
-            break;
+        name = info->helpers.get_u32(&sym->st_name);
+        if (name >= symbols->strings_size) {
+            continue;
         }
+
+        functions[count].start = info->helpers.get_u32(&sym->st_value) + SYMBOL_BASE(info, shndx);
+        functions[count].size = info->helpers.get_u32(&sym->st_size);
+        functions[count].name = symbols->strings + name;
+        count++;
     }
 
-    return EJ_RET_OK;
+    return count;
 }
 
-bool
-ejFindSymbol32(const ejElfInfo *info, const char *func_name, uint16_t section_index, ejSymbolValue *value)
+uint64_t
+ejCollectGlobalFunctions32(const ejElfInfo *info, const struct ejSymbolInfo *symbols,
+                           struct ejGlobalFunction *globals)
 {
-    const Elf32_Sym *syms = info->symbols.start;
+    uint64_t count = 0;
+    const Elf32_Sym *syms = symbols->start;
 
-    for (uint64_t k = 0; k < info->symbols.count; k++) {
+    for (uint64_t k = 0; k < symbols->count; k++) {
         uint32_t name;
         const Elf32_Sym *sym = &syms[k];
 
-        if (ELF32_ST_TYPE(sym->st_info) != STT_FUNC ||
-            info->helpers.get_u16(&sym->st_shndx) != section_index) {
+        if (ELF32_ST_TYPE(sym->st_info) != STT_FUNC || ELF32_ST_BIND(sym->st_info) == STB_LOCAL) {
             continue;
         }
 
         name = info->helpers.get_u32(&sym->st_name);
-        if (name >= info->symbols.strings_size) {
-            return false;
-        }
-        if (strcmp(info->symbols.strings + name, func_name) == 0) {
-            if (section_index == 0) {
-                value->index = k;
-            }
-            else {
-                value->addr = info->helpers.get_u32(&sym->st_value);
-            }
-            return true;
+        if (name == 0 || name >= symbols->strings_size) {
+            continue;
         }
+
+        globals[count].name = symbols->strings + name;
+        globals[count].value = info->helpers.get_u32(&sym->st_value);
+        globals[count].size = info->helpers.get_u32(&sym->st_size);
+        globals[count].index = k;
+        count++;
     }
 
-    return false;
+    return count;
 }
 
-ejAddr
-ejFindGotEntry32(const ejElfInfo *info, uint64_t symbol_index)
+void
+ejIndexGotSlots32(const ejElfInfo *info, const struct ejRelInfo *rels, struct ejGotIndex *index)
 {
-    const unsigned char *object = info->rels.start;
+    bool plt = (rels == &info->rels);
+    const unsigned char *object = rels->start;
+    const struct ejRelocTypes *types = ejLookupRelocTypes(info->visible.machine, info->visible.pointer_size);
+    EJ_TIMER_START(timer);
 
-    for (uint64_t k = 0; k < info->rels.count; k++, object += info->rels.object_size) {
+    for (uint64_t k = 0; k < rels->count; k++, object += rels->object_size) {
         uint32_t rel_info;
+        uint64_t symbol_index;
+        ejAddr offset;
+        enum ejRelocationKind kind;
+        struct ejGotSlot *slot;
+
+        EJ_STAT_INC(relocations_scanned);
+        rel_info = info->helpers.get_u32(object + rels->info_offset);
+        symbol_index = ELF32_R_SYM(rel_info);
+        if (symbol_index == 0 || symbol_index >= index->count) {
+            continue;
+        }
+
+        offset = info->helpers.get_u32(object);
+        if (types) {
+            kind = ejClassifyRelocation(info, types, ELF32_R_TYPE(rel_info), offset);
+        }
+        else {
+            kind = plt ? EJ_RELOC_JUMP_SLOT : EJ_RELOC_OTHER;
+        }
 
-        rel_info = info->helpers.get_u32(object + info->rels.info_offset);
-        if (ELF32_R_SYM(rel_info) == symbol_index) {
-            return info->helpers.get_u32(object);
+        slot = &index->slots[symbol_index];
+        if ((kind == EJ_RELOC_JUMP_SLOT && slot->kind != EJ_RELOC_JUMP_SLOT) ||
+            (kind == EJ_RELOC_GLOB_DAT && slot->kind == EJ_RELOC_OTHER)) {
+            slot->addr = offset;
+            slot->rel_index = (kind == EJ_RELOC_JUMP_SLOT && plt) ? k : EJ_NO_REL_INDEX;
+            slot->kind = kind;
         }
     }
 
-    return EJ_ADDR_NOT_FOUND;
+    EJ_TIMER_STOP(timer, EJ_PHASE_RELOCATIONS);
 }
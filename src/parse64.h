@@ -5,14 +5,18 @@
 #include "internal.h"
 
 int
-ejFindLoadAddr64(const struct ejIntHelpers *helpers, const void *pheader, uint32_t phnum,
-                 unsigned int *load_addr);
-
-int
-ejFindShdrs64(ejElfInfo *info, const struct ehdrParams *params);
+ejDecodeTables64(ejElfInfo *info, const struct ehdrParams *params);
 
 bool
-ejFindSymbol64(const ejElfInfo *info, const char *func_name, uint16_t section_index, ejSymbolValue *value);
+ejFindSymbol64(const ejElfInfo *info, const struct ejSymbolInfo *symbols, const char *func_name,
+               uint32_t section_index, ejSymbolValue *value);
+
+uint64_t
+ejCollectFunctions64(const ejElfInfo *info, const struct ejSymbolInfo *symbols, struct ejFunction *functions);
+
+uint64_t
+ejCollectGlobalFunctions64(const ejElfInfo *info, const struct ejSymbolInfo *symbols,
+                           struct ejGlobalFunction *globals);
 
-ejAddr
-ejFindGotEntry64(const ejElfInfo *info, uint64_t symbol_index);
+void
+ejIndexGotSlots64(const ejElfInfo *info, const struct ejRelInfo *rels, struct ejGotIndex *index);
@@ -0,0 +1,157 @@
+#define _GNU_SOURCE
+#include <limits.h>
+#include <stdlib.h>
+#include <sys/uio.h>
+
+#include "internal.h"
+
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif
+
+static int
+resolveSlots(struct ejGotPatch *patches, size_t count, unsigned char *pointer_size)
+{
+    bool little_endian = (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__);
+
+    *pointer_size = 0;
+    for (size_t k = 0; k < count; k++) {
+        struct ejGotPatch *patch = &patches[k];
+        const ejElfInfo *info = patch->info;
+
+        patch->slot = EJ_ADDR_NOT_FOUND;
+        patch->applied = false;
+        if (!INFO_INITIALIZED(info) || !patch->func_name) {
+            ejSetError(EJ_ERR_NULL_ARGUMENT);
+            return EJ_RET_BAD_USAGE;
+        }
+
+        if ((info->visible.pointer_size != 4 && info->visible.pointer_size != 8) ||
+            (*pointer_size != 0 && info->visible.pointer_size != *pointer_size) ||
+            info->visible.little_endian != little_endian ||
+            (info->visible.pointer_size == 4 && patch->new_value > UINT32_MAX)) {
+            ejSetError(EJ_ERR_BAD_POINTER_SIZE);
+            return EJ_RET_BAD_USAGE;
+        }
+        *pointer_size = info->visible.pointer_size;
+    }
+
+    for (size_t k = 0; k < count; k++) {
+        struct ejGotPatch *patch = &patches[k];
+        ejAddr slot;
+
+        slot = ejFindGotEntry(patch->info, patch->func_name);
+        if (slot == EJ_ADDR_NOT_FOUND) {
+            ejSetError(EJ_ERR_GOT_ENTRY_NOT_FOUND);
+            return EJ_RET_MISSING_INFO;
+        }
+        patch->slot = ejResolveAddress(patch->info, slot, patch->file_start);
+    }
+
+    return EJ_RET_OK;
+}
+
+static int
+patchChunk(pid_t pid, struct ejGotPatch *patches, size_t count, unsigned char pointer_size,
+           struct iovec *local, struct iovec *remote, unsigned char *buffer)
+{
+    ssize_t transferred;
+    size_t total = count * pointer_size;
+
+    for (size_t k = 0; k < count; k++) {
+        local[k].iov_base = buffer + k * pointer_size;
+        local[k].iov_len = pointer_size;
+        remote[k].iov_base = (void *)(uintptr_t)patches[k].slot;
+        remote[k].iov_len = pointer_size;
+    }
+
+    transferred = process_vm_readv(pid, local, count, remote, count, 0);
+    if (transferred < 0) {
+        ejSetSystemError(EJ_ERR_PROCESS_VM_READV, errno);
+        return EJ_RET_READ_FAILURE;
+    }
+    if ((size_t)transferred != total) {
+        ejSetSectionError(EJ_ERR_PARTIAL_TRANSFER, NULL, 0, transferred, total);
+        return EJ_RET_READ_FAILURE;
+    }
+
+    for (size_t k = 0; k < count; k++) {
+        unsigned char *value = buffer + k * pointer_size;
+
+        if (pointer_size == 8) {
+            uint64_t new_value = patches[k].new_value;
+
+            patches[k].old_value = patches[k].info->helpers.get_u64(value);
+            memcpy(value, &new_value, sizeof(new_value));
+        }
+        else {
+            uint32_t new_value = patches[k].new_value;
+
+            patches[k].old_value = patches[k].info->helpers.get_u32(value);
+            memcpy(value, &new_value, sizeof(new_value));
+        }
+    }
+
+    transferred = process_vm_writev(pid, local, count, remote, count, 0);
+    if (transferred < 0) {
+        ejSetSystemError(EJ_ERR_PROCESS_VM_WRITEV, errno);
+        return EJ_RET_WRITE_FAILURE;
+    }
+
+    for (size_t k = 0; k < (size_t)transferred / pointer_size; k++) {
+        patches[k].applied = true;
+    }
+    if ((size_t)transferred != total) {
+        ejSetSectionError(EJ_ERR_PARTIAL_TRANSFER, NULL, 0, transferred, total);
+        return EJ_RET_WRITE_FAILURE;
+    }
+
+    return EJ_RET_OK;
+}
+
+int
+ejPatchGotEntries(pid_t pid, struct ejGotPatch *patches, size_t count)
+{
+    int ret;
+    unsigned char pointer_size;
+    size_t chunk_size;
+    struct iovec *iovecs;
+    unsigned char *buffer;
+
+    if (!patches) {
+        ejSetError(EJ_ERR_NULL_ARGUMENT);
+        return EJ_RET_BAD_USAGE;
+    }
+    if (count == 0) {
+        return EJ_RET_OK;
+    }
+
+    ret = resolveSlots(patches, count, &pointer_size);
+    if (ret != EJ_RET_OK) {
+        return ret;
+    }
+
+    chunk_size = (count < IOV_MAX) ? count : IOV_MAX;
+    iovecs = malloc(sizeof(*iovecs) * chunk_size * 2);
+    buffer = malloc(chunk_size * pointer_size);
+    if (!iovecs || !buffer) {
+        ejSetError(EJ_ERR_OUT_OF_MEMORY);
+        ret = EJ_RET_OUT_OF_MEMORY;
+        goto done;
+    }
+
+    for (size_t k = 0; k < count; k += chunk_size) {
+        size_t remaining = count - k;
+
+        ret = patchChunk(pid, patches + k, (remaining < chunk_size) ? remaining : chunk_size, pointer_size,
+                         iovecs, iovecs + chunk_size, buffer);
+        if (ret != EJ_RET_OK) {
+            break;
+        }
+    }
+
+done:
+    free(iovecs);
+    free(buffer);
+    return ret;
+}
@@ -0,0 +1,137 @@
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "internal.h"
+
+static int
+compareVaddr(const void *a, const void *b)
+{
+    const struct ejSegment *first = a, *second = b;
+
+    return (first->vaddr > second->vaddr) - (first->vaddr < second->vaddr);
+}
+
+static int
+compareOffset(const void *a, const void *b)
+{
+    const struct ejSegment *first = a, *second = b;
+
+    return (first->offset > second->offset) - (first->offset < second->offset);
+}
+
+/*
+ * Returns the last segment whose start (as given by the field at field_offset) is at most value, or NULL if
+ * there is no such segment.
+ */
+static const struct ejSegment *
+searchLoads(const struct ejSegment *loads, uint32_t count, size_t field_offset, uint64_t value)
+{
+    uint32_t low = 0, high = count;
+
+    while (low < high) {
+        uint32_t middle = low + (high - low) / 2;
+
+        if (*(const uint64_t *)AT_OFFSET(&loads[middle], field_offset) <= value) {
+            low = middle + 1;
+        }
+        else {
+            high = middle;
+        }
+    }
+
+    return (low == 0) ? NULL : &loads[low - 1];
+}
+
+int
+ejBuildLoadMap(ejElfInfo *info)
+{
+    uint32_t count = 0;
+    struct ejSegment *loads;
+
+    for (uint32_t k = 0; k < info->layout.num_segments; k++) {
+        if (info->layout.segments[k].type == PT_LOAD) {
+            count++;
+        }
+    }
+    if (count == 0) {
+        ejSetError(EJ_ERR_NO_LOAD);
+        return EJ_RET_MISSING_INFO;
+    }
+
+    loads = malloc(sizeof(*loads) * count * 2);
+    if (!loads) {
+        ejSetError(EJ_ERR_OUT_OF_MEMORY);
+        return EJ_RET_OUT_OF_MEMORY;
+    }
+
+    count = 0;
+    for (uint32_t k = 0; k < info->layout.num_segments; k++) {
+        if (info->layout.segments[k].type == PT_LOAD) {
+            loads[count++] = info->layout.segments[k];
+        }
+    }
+    memcpy(loads + count, loads, sizeof(*loads) * count);
+    qsort(loads, count, sizeof(*loads), compareVaddr);
+    qsort(loads + count, count, sizeof(*loads), compareOffset);
+
+    info->layout.loads = loads;
+    info->layout.loads_by_offset = loads + count;
+    info->layout.num_loads = count;
+    return EJ_RET_OK;
+}
+
+ejAddr
+ejVaddrToOffset(const ejElfInfo *info, ejAddr vaddr)
+{
+    const struct ejSegment *load;
+
+    if (!info || !info->layout.loads) {
+        return EJ_ADDR_NOT_FOUND;
+    }
+
+    load = searchLoads(info->layout.loads, info->layout.num_loads, offsetof(struct ejSegment, vaddr), vaddr);
+    if (!load || vaddr - load->vaddr >= load->filesz) {
+        return EJ_ADDR_NOT_FOUND;
+    }
+
+    return load->offset + (vaddr - load->vaddr);
+}
+
+ejAddr
+ejOffsetToVaddr(const ejElfInfo *info, ejAddr offset)
+{
+    const struct ejSegment *load;
+
+    if (!info || !info->layout.loads) {
+        return EJ_ADDR_NOT_FOUND;
+    }
+
+    load = searchLoads(info->layout.loads_by_offset, info->layout.num_loads,
+                       offsetof(struct ejSegment, offset), offset);
+    if (!load || offset - load->offset >= load->filesz) {
+        return EJ_ADDR_NOT_FOUND;
+    }
+
+    return load->vaddr + (offset - load->offset);
+}
+
+ejAddr
+ejUnresolveAddress(const ejElfInfo *info, ejAddr addr, ejAddr file_start)
+{
+    const struct ejSegment *load;
+
+    if (!info || !info->layout.loads) {
+        return EJ_ADDR_NOT_FOUND;
+    }
+
+    if (info->dynamic) {
+        addr = addr - file_start + info->load_bias;
+    }
+
+    load = searchLoads(info->layout.loads, info->layout.num_loads, offsetof(struct ejSegment, vaddr), addr);
+    if (!load || addr - load->vaddr >= load->memsz) {
+        return EJ_ADDR_NOT_FOUND;
+    }
+
+    return addr;
+}
@@ -0,0 +1,49 @@
+#include <time.h>
+
+#include "internal.h"
+
+#ifdef EJ_STATS
+
+_Thread_local struct ejStats ejThreadStats;
+
+uint64_t
+ejNanoseconds(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+bool
+ejGetStats(struct ejStats *stats)
+{
+    if (!stats) {
+        return false;
+    }
+
+    *stats = ejThreadStats;
+    return true;
+}
+
+void
+ejResetStats(void)
+{
+    ejThreadStats = (struct ejStats){0};
+}
+
+#else  // EJ_STATS
+
+bool
+ejGetStats(struct ejStats *stats)
+{
+    (void)stats;
+    return false;
+}
+
+void
+ejResetStats(void)
+{
+}
+
+#endif  // EJ_STATS
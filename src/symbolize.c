@@ -0,0 +1,272 @@
+#include <stdlib.h>
+
+#include "internal.h"
+
+#define RADIX_BITS    8
+#define RADIX_BUCKETS (1 << RADIX_BITS)
+#define RADIX_PASSES  (64 / RADIX_BITS)
+
+// Batches smaller than this are resolved with one binary search per address rather than sorted.
+#define SMALL_BATCH 32
+
+struct pendingAddr {
+    ejAddr addr;
+    size_t position;
+};
+
+static int
+compareFunctions(const void *a, const void *b)
+{
+    const struct ejFunction *first = a, *second = b;
+
+    if (first->start != second->start) {
+        return (first->start > second->start) - (first->start < second->start);
+    }
+    return (first->size < second->size) - (first->size > second->size);
+}
+
+static uint64_t
+collectFunctions(const ejElfInfo *info, const struct ejSymbolInfo *symbols, struct ejFunction *functions)
+{
+    if (!symbols->start || !symbols->strings) {
+        return 0;
+    }
+    return info->collect_functions(info, symbols, functions);
+}
+
+static struct ejFunctionIndex *
+buildFunctionIndex(const ejElfInfo *info)
+{
+    uint64_t upper_bound, count = 0, unique = 0;
+    struct ejFunction *functions;
+    struct ejFunctionIndex *index;
+
+    upper_bound = info->symbols.count + info->full_symbols.count;
+    if (info->debug_info) {
+        upper_bound += info->debug_info->full_symbols.count;
+    }
+
+    index = malloc(sizeof(*index));
+    functions = malloc(sizeof(*functions) * (upper_bound + 1));
+    if (!index || !functions) {
+        free(index);
+        free(functions);
+        return NULL;
+    }
+
+    count += collectFunctions(info, &info->symbols, functions + count);
+    count += collectFunctions(info, &info->full_symbols, functions + count);
+    if (info->debug_info) {
+        count += collectFunctions(info->debug_info, &info->debug_info->full_symbols, functions + count);
+    }
+
+    if (info->in_process) {
+        for (uint64_t k = 0; k < count; k++) {
+            functions[k].start += info->base_addr;
+        }
+    }
+
+    qsort(functions, count, sizeof(*functions), compareFunctions);
+
+    // Aliases share a start address.  The sort placed the largest one first so keep that one.
+    for (uint64_t k = 0; k < count; k++) {
+        if (unique == 0 || functions[k].start != functions[unique - 1].start) {
+            functions[unique++] = functions[k];
+        }
+    }
+
+    index->functions = functions;
+    index->count = unique;
+    return index;
+}
+
+void
+ejFreeFunctionIndex(struct ejFunctionIndex *index)
+{
+    if (index) {
+        free(index->functions);
+        free(index);
+    }
+}
+
+static const struct ejFunctionIndex *
+getFunctionIndex(const ejElfInfo *info)
+{
+    struct ejFunctionIndex *index, *expected = NULL;
+
+    index = EJ_LOAD_INDEX(info->function_index);
+    if (index) {
+        EJ_STAT_INC(cache_hits);
+        return index;
+    }
+    EJ_STAT_INC(cache_misses);
+
+    index = buildFunctionIndex(info);
+    if (index && !EJ_PUBLISH_INDEX(((ejElfInfo *)info)->function_index, expected, index)) {
+        ejFreeFunctionIndex(index);
+        index = expected;
+    }
+    return index;
+}
+
+/*
+ * Returns the index of the first function in [low, count) whose start is greater than addr.
+ */
+static size_t
+upperBound(const struct ejFunction *functions, size_t low, size_t count, ejAddr addr)
+{
+    size_t high = count;
+
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+
+        if (functions[middle].start <= addr) {
+            low = middle + 1;
+        }
+        else {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
+static void
+fillResult(ejSymbolization *out, const struct ejFunctionIndex *index, size_t upper, ejAddr addr)
+{
+    const struct ejFunction *function;
+
+    *out = (ejSymbolization){0};
+    if (upper == 0) {
+        return;
+    }
+
+    function = &index->functions[upper - 1];
+    if (addr - function->start < function->size || addr == function->start) {
+        out->name = function->name;
+        out->start = function->start;
+        out->offset = addr - function->start;
+    }
+}
+
+const struct ejFunction *
+ejLookupFunction(const ejElfInfo *info, ejAddr addr)
+{
+    size_t upper;
+    const struct ejFunctionIndex *index;
+
+    index = getFunctionIndex(info);
+    if (!index) {
+        return NULL;
+    }
+
+    upper = upperBound(index->functions, 0, index->count, addr);
+    if (upper == 0 || index->functions[upper - 1].start != addr) {
+        return NULL;
+    }
+    return &index->functions[upper - 1];
+}
+
+/*
+ * Returns whichever of the two buffers ends up holding the sorted items.
+ */
+static struct pendingAddr *
+radixSort(struct pendingAddr *items, struct pendingAddr *scratch, size_t count)
+{
+    size_t histograms[RADIX_PASSES][RADIX_BUCKETS] = {{0}};
+
+    for (size_t k = 0; k < count; k++) {
+        for (unsigned int pass = 0; pass < RADIX_PASSES; pass++) {
+            histograms[pass][(items[k].addr >> (pass * RADIX_BITS)) & (RADIX_BUCKETS - 1)]++;
+        }
+    }
+
+    for (unsigned int pass = 0; pass < RADIX_PASSES; pass++) {
+        size_t total = 0;
+        size_t *histogram = histograms[pass];
+        struct pendingAddr *swap;
+
+        // Sampled addresses tend to share their upper bytes so many passes can be skipped entirely.
+        if (histogram[(items[0].addr >> (pass * RADIX_BITS)) & (RADIX_BUCKETS - 1)] == count) {
+            continue;
+        }
+
+        for (unsigned int bucket = 0; bucket < RADIX_BUCKETS; bucket++) {
+            size_t bucket_count = histogram[bucket];
+
+            histogram[bucket] = total;
+            total += bucket_count;
+        }
+
+        for (size_t k = 0; k < count; k++) {
+            scratch[histogram[(items[k].addr >> (pass * RADIX_BITS)) & (RADIX_BUCKETS - 1)]++] = items[k];
+        }
+
+        swap = items;
+        items = scratch;
+        scratch = swap;
+    }
+
+    return items;
+}
+
+int
+ejSymbolizeBatch(const ejElfInfo *info, const ejAddr *addrs, size_t count, ejSymbolization *out)
+{
+    size_t upper = 0;
+    const struct ejFunctionIndex *index;
+    struct pendingAddr *buffer, *items;
+
+    if (!INFO_INITIALIZED(info) || (count > 0 && (!addrs || !out))) {
+        ejSetError(EJ_ERR_NULL_ARGUMENT);
+        return EJ_RET_BAD_USAGE;
+    }
+
+    index = getFunctionIndex(info);
+    if (!index) {
+        ejSetError(EJ_ERR_OUT_OF_MEMORY);
+        return EJ_RET_OUT_OF_MEMORY;
+    }
+
+    if (count < SMALL_BATCH) {
+        for (size_t k = 0; k < count; k++) {
+            fillResult(&out[k], index, upperBound(index->functions, 0, index->count, addrs[k]), addrs[k]);
+        }
+        return EJ_RET_OK;
+    }
+
+    buffer = malloc(sizeof(*buffer) * count * 2);
+    if (!buffer) {
+        ejSetError(EJ_ERR_OUT_OF_MEMORY);
+        return EJ_RET_OUT_OF_MEMORY;
+    }
+
+    for (size_t k = 0; k < count; k++) {
+        buffer[k].addr = addrs[k];
+        buffer[k].position = k;
+    }
+    items = radixSort(buffer, buffer + count, count);
+
+    for (size_t k = 0; k < count; k++) {
+        ejAddr addr = items[k].addr;
+        size_t low = upper, high, step = 1;
+
+        if (k > 0 && addr == items[k - 1].addr) {
+            out[items[k].position] = out[items[k - 1].position];
+            continue;
+        }
+
+        // Gallop forward from the previous match since the addresses are now in ascending order.
+        while (low + step <= index->count && index->functions[low + step - 1].start <= addr) {
+            low += step;
+            step *= 2;
+        }
+        high = (low + step <= index->count) ? low + step - 1 : index->count;
+
+        upper = upperBound(index->functions, low, high, addr);
+        fillResult(&out[items[k].position], index, upper, addr);
+    }
+
+    free(buffer);
+    return EJ_RET_OK;
+}
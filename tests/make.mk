@@ -0,0 +1,14 @@
+TESTS := $(patsubst $(TEST_DIR)/%.c,$(TEST_DIR)/%,$(wildcard $(TEST_DIR)/*.c))
+
+# patch.c writes to the GOT of a forked copy of itself, which RELRO would make read-only.
+$(TEST_DIR)/%: $(TEST_DIR)/%.c $(EJ_STATIC_LIBRARY)
+	$(CC) $(CFLAGS) $(EJ_INCLUDE_FLAGS) $(filter %.c %.a,$^) -Wl,-z,lazy,-z,norelro -ldl -lpthread -o $@
+
+test: $(TESTS)
+	@for test in $(TESTS); do echo "Running $$test"; ./$$test || exit 1; done
+
+test_clean:
+	@rm -f $(TESTS)
+
+.PHONY: test test_clean
+CLEAN_TARGETS += test_clean
@@ -0,0 +1,125 @@
+#define _GNU_SOURCE
+#include <link.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <elfjack/elfjack.h>
+
+struct image {
+    unsigned char *data;
+    size_t size;
+};
+
+static int
+readImage(const char *path, struct image *image)
+{
+    FILE *file;
+    long size;
+
+    file = fopen(path, "rb");
+    if (!file) {
+        perror("fopen");
+        return -1;
+    }
+    if (fseek(file, 0, SEEK_END) != 0 || (size = ftell(file)) < 0 || fseek(file, 0, SEEK_SET) != 0) {
+        perror("fseek");
+        fclose(file);
+        return -1;
+    }
+    image->size = size;
+    image->data = malloc(image->size);
+    if (!image->data || fread(image->data, 1, image->size, file) != image->size) {
+        fprintf(stderr, "Failed to read %s\n", path);
+        free(image->data);
+        fclose(file);
+        return -1;
+    }
+    fclose(file);
+    return 0;
+}
+
+static ElfW(Shdr) *
+findSection(const struct image *image, const char *name)
+{
+    const ElfW(Ehdr) *ehdr = (const void *)image->data;
+    ElfW(Shdr) *shdrs = (void *)(image->data + ehdr->e_shoff);
+    const char *names = (const char *)image->data + shdrs[ehdr->e_shstrndx].sh_offset;
+
+    for (ElfW(Half) k = 1; k < ehdr->e_shnum; k++) {
+        if (strcmp(names + shdrs[k].sh_name, name) == 0) {
+            return &shdrs[k];
+        }
+    }
+    return NULL;
+}
+
+// Parses the mutated copy and expects it to be rejected as malformed rather than crashing the lookup.
+static int
+expectMalformed(const struct image *image, const char *description)
+{
+    int ret;
+    ejElfInfo info;
+
+    ret = ejParseElfMemory(image->data, image->size, &info);
+    if (ret == EJ_RET_OK) {
+        ejFindFunction(&info, "main");
+        ejReleaseInfo(&info);
+        fprintf(stderr, "%s: the file was accepted\n", description);
+        return 1;
+    }
+    if (ret != EJ_RET_MALFORMED_ELF) {
+        fprintf(stderr, "%s: unexpected error: %s\n", description, ejGetError());
+        return 1;
+    }
+    return 0;
+}
+
+/*
+ * Each case corrupts one field of a copy of this executable.  Sections are looked up by name in the pristine
+ * copy and the corrupted field is restored afterwards.
+ */
+int
+main(void)
+{
+    int failures = 0;
+    struct image image;
+    ElfW(Shdr) *interp, *dynstr, *dynsym, *relocations, saved;
+
+    if (readImage("/proc/self/exe", &image) != 0) {
+        return 1;
+    }
+
+    interp = findSection(&image, ".interp");
+    dynstr = findSection(&image, ".dynstr");
+    dynsym = findSection(&image, ".dynsym");
+    relocations = findSection(&image, (sizeof(void *) == 8) ? ".rela.plt" : ".rel.plt");
+    if (!interp || !dynstr || !dynsym || !relocations || interp > dynstr) {
+        fprintf(stderr, "The test executable lacks the expected sections\n");
+        free(image.data);
+        return 1;
+    }
+
+    // A SHT_NULL section named .dynstr which lies outside of the file.
+    saved = *interp;
+    interp->sh_name = dynstr->sh_name;
+    interp->sh_type = SHT_NULL;
+    interp->sh_offset = (ElfW(Off))1 << (sizeof(ElfW(Off)) * 8 - 2);
+    failures += expectMalformed(&image, "SHT_NULL .dynstr out of range");
+    *interp = saved;
+
+    saved = *dynsym;
+    dynsym->sh_entsize = 1;
+    failures += expectMalformed(&image, ".dynsym with sh_entsize 1");
+    *dynsym = saved;
+
+    saved = *relocations;
+    relocations->sh_entsize = 1;
+    failures += expectMalformed(&image, "PLT relocations with sh_entsize 1");
+    relocations->sh_entsize = 0;
+    failures += expectMalformed(&image, "PLT relocations with sh_entsize 0");
+    *relocations = saved;
+
+    free(image.data);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,87 @@
+#define _GNU_SOURCE
+#include <link.h>
+#include <stdio.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <elfjack/elfjack.h>
+
+static int
+findFileStart(struct dl_phdr_info *module, size_t size, void *data)
+{
+    ejAddr lowest = EJ_ADDR_NOT_FOUND;
+    (void)size;
+
+    // The executable is always reported first.
+    for (ElfW(Half) k = 0; k < module->dlpi_phnum; k++) {
+        if (module->dlpi_phdr[k].p_type == PT_LOAD && module->dlpi_phdr[k].p_vaddr < lowest) {
+            lowest = module->dlpi_phdr[k].p_vaddr;
+        }
+    }
+    *(ejAddr *)data = module->dlpi_addr + (lowest & ~((ejAddr)getpagesize() - 1));
+    return 1;
+}
+
+/*
+ * Forks a child which waits for the parent and then calls getppid() through its PLT.  The parent redirects
+ * the child's GOT entry for getppid to getpid, so the child sees its own pid.
+ */
+int
+main(void)
+{
+    int ret, status, fds[2];
+    char go = 0;
+    pid_t child;
+    ejElfInfo info;
+    struct ejGotPatch patch = {.func_name = "getppid", .new_value = (ejAddr)(uintptr_t)getpid};
+
+    if (pipe(fds) != 0) {
+        perror("pipe");
+        return 1;
+    }
+
+    child = fork();
+    if (child < 0) {
+        perror("fork");
+        return 1;
+    }
+    if (child == 0) {
+        close(fds[1]);
+        if (read(fds[0], &go, 1) != 1) {
+            _exit(2);
+        }
+        _exit((getppid() == getpid()) ? 0 : 1);
+    }
+    close(fds[0]);
+
+    ret = ejParseElf("/proc/self/exe", &info);
+    if (ret != EJ_RET_OK) {
+        fprintf(stderr, "Failed to parse ELF file: %s\n", ejGetError());
+        goto done;
+    }
+
+    patch.info = &info;
+    dl_iterate_phdr(findFileStart, &patch.file_start);
+    ret = ejPatchGotEntries(child, &patch, 1);
+    if (ret != EJ_RET_OK || !patch.applied) {
+        fprintf(stderr, "Failed to patch the child: %s\n", ejGetError());
+        ret = (ret == EJ_RET_OK) ? 1 : ret;
+    }
+    ejReleaseInfo(&info);
+
+done:
+    if (write(fds[1], &go, 1) != 1) {
+        perror("write");
+    }
+    close(fds[1]);
+    if (waitpid(child, &status, 0) != child || !WIFEXITED(status)) {
+        fprintf(stderr, "The child didn't exit normally\n");
+        return 1;
+    }
+    if (ret == EJ_RET_OK && WEXITSTATUS(status) != 0) {
+        fprintf(stderr, "The child's call to getppid wasn't redirected\n");
+        ret = 1;
+    }
+
+    return ret;
+}
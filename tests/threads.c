@@ -0,0 +1,96 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <elfjack/elfjack.h>
+
+#define NUM_THREADS 32
+#define NUM_ROUNDS  50
+
+struct expected {
+    ejAddr worker;
+    ejAddr got_entry;
+};
+
+struct shared {
+    const ejElfInfo *info;
+    const struct expected *expected;
+    pthread_barrier_t barrier;
+    int failures;
+};
+
+/*
+ * Every thread queries the same freshly parsed info object at once, so the lazily built function and GOT
+ * indexes are raced to publication on every round.
+ */
+static void *
+worker(void *data)
+{
+    struct shared *shared = data;
+    const struct expected *expected = shared->expected;
+    ejAddr addr = expected->worker + 1;
+    ejSymbolization result;
+    bool ok;
+
+    pthread_barrier_wait(&shared->barrier);
+
+    ok = ejFindFunction(shared->info, "worker") == expected->worker &&
+         ejFindGotEntry(shared->info, "pthread_create") == expected->got_entry &&
+         ejSymbolizeBatch(shared->info, &addr, 1, &result) == EJ_RET_OK && result.name &&
+         strcmp(result.name, "worker") == 0 && result.offset == 1;
+    if (!ok) {
+        __atomic_add_fetch(&shared->failures, 1, __ATOMIC_RELAXED);
+    }
+
+    return NULL;
+}
+
+int
+main(void)
+{
+    int ret;
+    ejElfInfo info;
+    struct expected expected;
+    struct shared shared = {.expected = &expected};
+    pthread_t threads[NUM_THREADS];
+
+    ret = ejParseElf("/proc/self/exe", &info);
+    if (ret != EJ_RET_OK) {
+        fprintf(stderr, "Failed to parse ELF file: %s\n", ejGetError());
+        return ret;
+    }
+    expected.worker = ejFindFunction(&info, "worker");
+    expected.got_entry = ejFindGotEntry(&info, "pthread_create");
+    ejReleaseInfo(&info);
+    if (expected.worker == EJ_ADDR_NOT_FOUND || expected.got_entry == EJ_ADDR_NOT_FOUND) {
+        fprintf(stderr, "Failed to find worker or the GOT entry for pthread_create\n");
+        return 1;
+    }
+
+    for (unsigned int round = 0; round < NUM_ROUNDS && shared.failures == 0; round++) {
+        ret = ejParseElf("/proc/self/exe", &info);
+        if (ret != EJ_RET_OK) {
+            fprintf(stderr, "Failed to parse ELF file: %s\n", ejGetError());
+            return ret;
+        }
+
+        shared.info = &info;
+        pthread_barrier_init(&shared.barrier, NULL, NUM_THREADS);
+        for (unsigned int k = 0; k < NUM_THREADS; k++) {
+            pthread_create(&threads[k], NULL, worker, &shared);
+        }
+        for (unsigned int k = 0; k < NUM_THREADS; k++) {
+            pthread_join(threads[k], NULL);
+        }
+        pthread_barrier_destroy(&shared.barrier);
+
+        ejReleaseInfo(&info);
+    }
+
+    if (shared.failures != 0) {
+        fprintf(stderr, "%d lookups returned the wrong result\n", shared.failures);
+        return 1;
+    }
+
+    return 0;
+}